@@ -0,0 +1,24 @@
+#include <GoProControl.h>
+#include <CommandProtocol.h>
+#include "Constants.h"
+
+/*
+  Drive the camera from a ground station with the binary protocol described in CommandProtocol.h
+  the debug output is disabled since it would share the Serial with the protocol
+*/
+
+GoProControl gp(GOPRO_SSID, GOPRO_PASS, CAMERA);
+GoProControl *cameras[] = {&gp};
+CommandProtocol protocol(cameras, 1);
+
+void setup()
+{
+  Serial.begin(115200);
+}
+
+void loop()
+{
+  protocol.read(Serial);
+  protocol.handle(Serial);
+  gp.keepAlive();
+}
@@ -0,0 +1,64 @@
+#include <GoProControl.h>
+#include <ClockSync.h>
+#include "Constants.h"
+
+#if !defined(GOPRO_SCHEDULE)
+#error "uncomment GOPRO_SCHEDULE in Settings.h"
+#endif
+
+/*
+  Fire several cameras at the same instant
+  every board runs this sketch, one of them with MASTER true, all must be on the same network
+  each board shoots on every multiple of 10 seconds of the master clock
+*/
+
+#define PERIOD 10000
+#define RESYNC_PERIOD 60000 // the clocks drift a few ms per minute, synchronize() blocks for a few round trips
+
+GoProControl gp(GOPRO_SSID, GOPRO_PASS, CAMERA);
+ClockSync clock_sync;
+uint32_t synced_at;
+
+void setup()
+{
+  gp.enableDebug(&Serial);
+  gp.begin();
+
+  if (MASTER)
+  {
+    clock_sync.beginMaster();
+  }
+  else
+  {
+    while (clock_sync.synchronize(MASTER_IP) != true) // nothing to schedule before the first one
+    {
+      delay(1000);
+    }
+    synced_at = millis();
+  }
+}
+
+void loop()
+{
+  if (MASTER)
+  {
+    clock_sync.handle();
+  }
+  else if (!gp.isScheduled() && millis() - synced_at >= RESYNC_PERIOD)
+  {
+    if (clock_sync.synchronize(MASTER_IP) == true) // on failure the previous offset is kept
+    {
+      synced_at = millis();
+    }
+  }
+
+  if (!gp.isScheduled())
+  {
+    // next multiple of PERIOD on the master clock, converted to our millis()
+    const uint32_t next = (clock_sync.masterMillis() / PERIOD + 1) * PERIOD;
+    gp.scheduleShoot(clock_sync.toLocal(next));
+  }
+
+  gp.handleSchedule(); // not needed on ESP32, a task fires the shot
+  gp.keepAlive();
+}
@@ -0,0 +1,289 @@
+/*
+Arduino.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+
+static uint8_t pin_values[HOST_PINS];
+static void (*pin_isrs[HOST_PINS])(void);
+static int pin_isr_modes[HOST_PINS];
+
+////////////////////////////////////////////////////////////
+////////                  Time                      ////////
+////////////////////////////////////////////////////////////
+
+static uint64_t monotonicMicros()
+{
+    static uint64_t start = 0;
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64_t us = (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+    if (start == 0)
+    {
+        start = us;
+    }
+    return us - start;
+}
+
+unsigned long millis()
+{
+    return (uint32_t)(monotonicMicros() / 1000); // wraps after 49 days like on a board
+}
+
+unsigned long micros()
+{
+    return (uint32_t)monotonicMicros();
+}
+
+void delay(unsigned long ms)
+{
+    usleep(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    usleep(us);
+}
+
+void yield()
+{
+}
+
+long random(long howbig)
+{
+    return howbig <= 0 ? 0 : rand() % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed)
+{
+    srand(seed);
+}
+
+////////////////////////////////////////////////////////////
+////////                  Pins                      ////////
+////////////////////////////////////////////////////////////
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pin < HOST_PINS ? pin_values[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < HOST_PINS)
+    {
+        pin_values[pin] = value ? HIGH : LOW;
+    }
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode)
+{
+    if (interrupt < HOST_PINS)
+    {
+        pin_isrs[interrupt] = isr;
+        pin_isr_modes[interrupt] = mode;
+    }
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+    if (interrupt < HOST_PINS)
+    {
+        pin_isrs[interrupt] = NULL;
+    }
+}
+
+void noInterrupts()
+{
+}
+
+void interrupts()
+{
+}
+
+void hostPinWrite(uint8_t pin, uint8_t value)
+{
+    if (pin >= HOST_PINS)
+    {
+        return;
+    }
+    const uint8_t before = pin_values[pin];
+    digitalWrite(pin, value);
+    const uint8_t after = pin_values[pin];
+    const int mode = pin_isr_modes[pin];
+    if (pin_isrs[pin] != NULL && before != after &&
+        (mode == CHANGE || (mode == RISING && after == HIGH) || (mode == FALLING && after == LOW)))
+    {
+        pin_isrs[pin]();
+    }
+}
+
+////////////////////////////////////////////////////////////
+////////                 Numbers                    ////////
+////////////////////////////////////////////////////////////
+
+static char *toText(unsigned long value, char *buffer, const int base, const bool negative)
+{
+    char digits[sizeof(unsigned long) * 8 + 1];
+    uint8_t count = 0;
+    do
+    {
+        const uint8_t digit = value % base;
+        digits[count++] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value > 0);
+
+    char *text = buffer;
+    if (negative)
+    {
+        *text++ = '-';
+    }
+    while (count > 0)
+    {
+        *text++ = digits[--count];
+    }
+    *text = '\0';
+    return buffer;
+}
+
+char *itoa(int value, char *buffer, int base)
+{
+    return ltoa(value, buffer, base);
+}
+
+char *utoa(unsigned int value, char *buffer, int base)
+{
+    return toText(value, buffer, base, false);
+}
+
+char *ltoa(long value, char *buffer, int base)
+{
+    const bool negative = value < 0 && base == 10;
+    return toText(negative ? -(unsigned long)value : (unsigned long)value, buffer, base, negative);
+}
+
+char *ultoa(unsigned long value, char *buffer, int base)
+{
+    return toText(value, buffer, base, false);
+}
+
+////////////////////////////////////////////////////////////
+////////                  Print                     ////////
+////////////////////////////////////////////////////////////
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (size-- > 0 && write(*buffer++) == 1)
+    {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::printNumber(unsigned long value, int base)
+{
+    char text[sizeof(unsigned long) * 8 + 1];
+    return write(ultoa(value, text, base < 2 ? DEC : base));
+}
+
+size_t Print::printSigned(long value, int base)
+{
+    char text[sizeof(long) * 8 + 2];
+    return write(ltoa(value, text, base < 2 ? DEC : base));
+}
+
+size_t Print::print(double value, int digits)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+int HardwareSerial::available()
+{
+    if (_peeked >= 0)
+    {
+        return 1;
+    }
+    pollfd input = {STDIN_FILENO, POLLIN, 0};
+    return poll(&input, 1, 0) > 0 && (input.revents & POLLIN) ? 1 : 0;
+}
+
+int HardwareSerial::read()
+{
+    const int c = peek();
+    _peeked = -1;
+    return c;
+}
+
+int HardwareSerial::peek()
+{
+    uint8_t c;
+    if (_peeked < 0 && available() && ::read(STDIN_FILENO, &c, 1) == 1)
+    {
+        _peeked = c;
+    }
+    return _peeked;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+bool IPAddress::fromString(const char *address)
+{
+    return inet_pton(AF_INET, address, _bytes) == 1;
+}
+
+size_t IPAddress::printTo(Print &p) const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+    return p.write(text);
+}
@@ -0,0 +1,210 @@
+/*
+Arduino.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// The part of the Arduino API the library uses, on Linux and macOS: the host build compiles
+// src/ with this folder first in the include path and without ARDUINO defined, see the Makefile
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+
+#define DEC 10
+#define HEX 16
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define digitalPinToInterrupt(pin) (pin)
+#define HOST_PINS 64
+
+typedef bool boolean;
+typedef uint8_t byte;
+class __FlashStringHelper;
+
+template <class T, class U>
+typename std::common_type<T, U>::type min(const T a, const U b) { return a < b ? a : b; }
+template <class T, class U>
+typename std::common_type<T, U>::type max(const T a, const U b) { return a > b ? a : b; }
+template <class T, class U, class V>
+T constrain(const T value, const U low, const V high) { return value < low ? low : (value > high ? high : value); }
+
+// time since the start of the program, on the monotonic clock
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+// the pins are variables: a test drives an input with hostPinWrite(), which runs the interrupt
+// attached to it like the edge on a board would
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+void hostPinWrite(uint8_t pin, uint8_t value);
+
+char *itoa(int value, char *buffer, int base);
+char *utoa(unsigned int value, char *buffer, int base);
+char *ltoa(long value, char *buffer, int base);
+char *ultoa(unsigned long value, char *buffer, int base);
+
+// only what the deprecated String constructor of GoProControl needs
+class String
+{
+  public:
+    String(const char *text = "") : _text(text != NULL ? text : "") {}
+    const char *c_str() const { return _text.c_str(); }
+    unsigned int length() const { return _text.size(); }
+
+  private:
+    std::string _text;
+};
+
+class Print;
+
+class Printable
+{
+  public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text) { return text == NULL ? 0 : write((const uint8_t *)text, strlen(text)); }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *text) { return write((const char *)text); }
+    size_t print(const char text[]) { return write(text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return printNumber(value, base); }
+    size_t print(int value, int base = DEC) { return printSigned(value, base); }
+    size_t print(unsigned int value, int base = DEC) { return printNumber(value, base); }
+    size_t print(long value, int base = DEC) { return printSigned(value, base); }
+    size_t print(unsigned long value, int base = DEC) { return printNumber(value, base); }
+    size_t print(double value, int digits = 2);
+    size_t print(const Printable &value) { return value.printTo(*this); }
+
+    size_t println() { return write("\r\n"); }
+    template <class T>
+    size_t println(const T &value) { return print(value) + println(); }
+    template <class T>
+    size_t println(const T &value, int format) { return print(value, format) + println(); }
+    size_t println(const char text[]) { return print(text) + println(); }
+    size_t println(const __FlashStringHelper *text) { return print(text) + println(); }
+
+  private:
+    size_t printNumber(unsigned long value, int base);
+    size_t printSigned(long value, int base);
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+  protected:
+    unsigned long _timeout = 1000;
+};
+
+// Serial writes to stdout and reads stdin without blocking
+class HardwareSerial : public Stream
+{
+  public:
+    void begin(unsigned long) {}
+    void end() {}
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    using Print::write;
+    void flush();
+    operator bool() { return true; }
+
+  private:
+    int _peeked = -1;
+};
+
+extern HardwareSerial Serial;
+
+class IPAddress : public Printable
+{
+  public:
+    IPAddress() { memset(_bytes, 0, sizeof(_bytes)); }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        _bytes[0] = a;
+        _bytes[1] = b;
+        _bytes[2] = c;
+        _bytes[3] = d;
+    }
+    bool fromString(const char *address);
+    uint8_t operator[](int index) const { return _bytes[index]; }
+    uint8_t &operator[](int index) { return _bytes[index]; }
+    bool operator==(const IPAddress &other) const { return memcmp(_bytes, other._bytes, sizeof(_bytes)) == 0; }
+    size_t printTo(Print &p) const;
+
+  private:
+    uint8_t _bytes[4];
+};
+
+#endif // HOST_ARDUINO_H
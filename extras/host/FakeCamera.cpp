@@ -0,0 +1,296 @@
+/*
+FakeCamera.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Arduino.h>
+#include <FakeCamera.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if !defined(MSG_NOSIGNAL) // macOS
+#define MSG_NOSIGNAL 0
+#endif
+
+FakeCameras::FakeCameras()
+{
+    _running = false;
+}
+
+FakeCameras::~FakeCameras()
+{
+    stop();
+    for (size_t i = 0; i < _cameras.size(); i++)
+    {
+        ::close(_cameras[i].listener);
+    }
+}
+
+int FakeCameras::add(const char *address, const uint16_t port, const char *model_name,
+                     const uint16_t delay_min, const uint16_t delay_max, const bool silent)
+{
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    if (inet_pton(AF_INET, address, &local.sin_addr) != 1)
+    {
+        return -1;
+    }
+
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    const int on = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (listener < 0 || bind(listener, (sockaddr *)&local, sizeof(local)) < 0 || listen(listener, 64) < 0)
+    {
+        ::close(listener);
+        return -1;
+    }
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+    Camera camera;
+    camera.listener = listener;
+    camera.model_name = model_name;
+    camera.delay_min = delay_min;
+    camera.delay_max = max(delay_min, delay_max);
+    camera.silent = silent;
+    camera.requests = 0;
+    camera.status[0] = 0;
+    camera.status[1] = 1;
+    camera.status[2] = 87;
+    camera.status[3] = 4521;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    _cameras.push_back(camera);
+    return _cameras.size() - 1;
+}
+
+bool FakeCameras::start()
+{
+    if (_running)
+    {
+        return false;
+    }
+    _running = true;
+    _thread = std::thread(&FakeCameras::serve, this);
+    return true;
+}
+
+void FakeCameras::stop()
+{
+    if (!_running)
+    {
+        return;
+    }
+    _running = false;
+    _thread.join();
+    for (size_t i = 0; i < _connections.size(); i++)
+    {
+        ::close(_connections[i].socket);
+    }
+    _connections.clear();
+}
+
+uint32_t FakeCameras::requests(const int camera)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _cameras[camera].requests;
+}
+
+std::string FakeCameras::lastPath(const int camera)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _cameras[camera].last_path;
+}
+
+void FakeCameras::setStatus(const int camera, const int recording, const int mode, const int battery, const int video_left)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    int *status = _cameras[camera].status;
+    status[0] = recording;
+    status[1] = mode;
+    status[2] = battery;
+    status[3] = video_left;
+}
+
+void FakeCameras::serve()
+{
+    std::vector<pollfd> watched;
+    while (_running)
+    {
+        // listeners first, then the connections in the same order as _connections
+        watched.clear();
+        int32_t timeout = 10; // how late stop() can be
+        const uint32_t now = millis();
+        for (size_t i = 0; i < _cameras.size(); i++)
+        {
+            pollfd listener = {_cameras[i].listener, POLLIN, 0};
+            watched.push_back(listener);
+        }
+        for (size_t i = 0; i < _connections.size(); i++)
+        {
+            pollfd connection = {_connections[i].socket, POLLIN, 0};
+            watched.push_back(connection);
+            if (_connections[i].waiting)
+            {
+                timeout = min(timeout, max((int32_t)(_connections[i].answer_at - now), (int32_t)0));
+            }
+        }
+        poll(watched.data(), watched.size(), timeout);
+
+        for (size_t i = 0; i < _cameras.size(); i++)
+        {
+            if (watched[i].revents & POLLIN)
+            {
+                const int socket = accept(_cameras[i].listener, NULL, NULL);
+                if (socket >= 0)
+                {
+                    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+                    Connection connection = {socket, (int)i, "", "", 0, false};
+                    _connections.push_back(connection);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < _connections.size(); i++)
+        {
+            Connection &connection = _connections[i];
+            const size_t index = _cameras.size() + i;
+            if (index < watched.size() && (watched[index].revents & (POLLIN | POLLHUP | POLLERR)))
+            {
+                char chunk[512];
+                const ssize_t length = recv(connection.socket, chunk, sizeof(chunk), 0);
+                if (length <= 0)
+                {
+                    ::close(connection.socket);
+                    connection.socket = -1;
+                    continue;
+                }
+                connection.input.append(chunk, length);
+            }
+            if (!connection.waiting)
+            {
+                readRequest(connection);
+            }
+            if (connection.waiting && (int32_t)(millis() - connection.answer_at) >= 0)
+            {
+                send(connection.socket, connection.answer.data(), connection.answer.size(), MSG_NOSIGNAL);
+                connection.waiting = false;
+                readRequest(connection); // the client may have sent the next one already
+            }
+        }
+
+        for (size_t i = _connections.size(); i-- > 0;)
+        {
+            if (_connections[i].socket < 0)
+            {
+                _connections.erase(_connections.begin() + i);
+            }
+        }
+    }
+}
+
+// take the first whole request out of the input and prepare its answer
+void FakeCameras::readRequest(Connection &connection)
+{
+    const size_t end = connection.input.find("\r\n\r\n");
+    if (end == std::string::npos)
+    {
+        return;
+    }
+    const std::string request = connection.input.substr(0, end);
+    connection.input.erase(0, end + 4);
+
+    // "GET /gp/gpControl/status HTTP/1.1"
+    const size_t path_start = request.find(' ') + 1;
+    const size_t path_end = request.find(' ', path_start);
+    const std::string path = request.substr(path_start, path_end - path_start);
+
+    std::lock_guard<std::mutex> guard(_lock);
+    Camera &camera = _cameras[connection.camera];
+    camera.requests++;
+    camera.last_path = path;
+    if (camera.silent)
+    {
+        return;
+    }
+    connection.answer = answer(camera, path);
+    connection.answer_at = millis() + camera.delay_min + random(camera.delay_max - camera.delay_min + 1);
+    connection.waiting = true;
+}
+
+std::string FakeCameras::answer(Camera &camera, const std::string &path)
+{
+    char body[160];
+    if (path.find("/gp/gpControl/status") == 0)
+    {
+        snprintf(body, sizeof(body), "{\"status\":{\"8\":%d,\"43\":%d,\"70\":%d,\"35\":%d},\"settings\":{}}",
+                 camera.status[0], camera.status[1], camera.status[2], camera.status[3]);
+    }
+    else if (path.find("/gp/gpControl/info") == 0)
+    {
+        snprintf(body, sizeof(body), "{\"info\":{\"model_name\":\"%s\",\"firmware_version\":\"HD5.02.02.60.00\"}}",
+                 camera.model_name.c_str());
+    }
+    else
+    {
+        strcpy(body, "{}");
+    }
+
+    char head[96];
+    snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n",
+             (unsigned)strlen(body));
+    return std::string(head) + body;
+}
+
+////////////////////////////////////////////////////////////
+////////                Transport                   ////////
+////////////////////////////////////////////////////////////
+
+FakeCameraTransport::FakeCameraTransport(const char *address, const uint16_t port)
+{
+    reach(address, port);
+}
+
+void FakeCameraTransport::reach(const char *address, const uint16_t port)
+{
+    strncpy(_address, address, sizeof(_address) - 1);
+    _address[sizeof(_address) - 1] = '\0';
+    _port = port;
+}
+
+bool FakeCameraTransport::connect(const char *, const uint16_t, const uint16_t timeout)
+{
+    return PosixTransport::connect(_address, _port, timeout);
+}
+
+bool FakeCameraTransport::startConnect(const char *, const uint16_t, const uint16_t timeout)
+{
+    return PosixTransport::startConnect(_address, _port, timeout);
+}
+
+bool FakeCameraTransport::sendDatagram(const char *, const uint16_t, const uint8_t *, const size_t)
+{
+    return true;
+}
@@ -0,0 +1,103 @@
+/*
+FakeCamera.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef FAKE_CAMERA_H
+#define FAKE_CAMERA_H
+
+#include <PosixTransport.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cameras that answer like the real ones over HTTP on loopback, for the host tests and the
+// gateway benchmark. Every camera listens on its own address (127.0.0.0/8 is all loopback on
+// Linux; macOS needs "ifconfig lo0 alias 127.0.0.x" first) and one thread serves all of them
+class FakeCameras
+{
+  public:
+    FakeCameras();
+    ~FakeCameras();
+
+    // the index of the new camera, -1 if its address can't be listened on. Every answer waits
+    // between delay_min and delay_max ms, a camera with silent true never answers
+    int add(const char *address, const uint16_t port, const char *model_name = "HERO5 Black",
+            const uint16_t delay_min = 0, const uint16_t delay_max = 0, const bool silent = false);
+    bool start();
+    void stop();
+
+    // what the camera received, for the tests
+    uint32_t requests(const int camera);
+    std::string lastPath(const int camera);
+    // status 8 (recording), 43 (mode), 70 (battery) and 35 (video left) of the answers
+    void setStatus(const int camera, const int recording, const int mode, const int battery, const int video_left);
+
+  private:
+    struct Camera
+    {
+        int listener;
+        std::string model_name;
+        uint16_t delay_min;
+        uint16_t delay_max;
+        bool silent;
+        uint32_t requests;
+        std::string last_path;
+        int status[4];
+    };
+    struct Connection
+    {
+        int socket;
+        int camera;
+        std::string input;
+        std::string answer;
+        uint32_t answer_at;
+        bool waiting; // a request was read, its answer isn't sent yet
+    };
+
+    std::vector<Camera> _cameras;
+    std::vector<Connection> _connections;
+    std::mutex _lock;
+    std::thread _thread;
+    volatile bool _running;
+
+    void serve();
+    void readRequest(Connection &connection);
+    std::string answer(Camera &camera, const std::string &path);
+};
+
+// PosixTransport to a fake camera: whatever the library asks for (10.5.5.9:80), it connects to
+// address:port. The wake on lan datagrams go nowhere
+class FakeCameraTransport : public PosixTransport
+{
+  public:
+    FakeCameraTransport(const char *address = "127.0.0.1", const uint16_t port = 8080);
+    void reach(const char *address, const uint16_t port);
+
+    bool connect(const char *host, const uint16_t port, const uint16_t timeout);
+    bool startConnect(const char *host, const uint16_t port, const uint16_t timeout);
+    bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size);
+
+  private:
+    char _address[16];
+    uint16_t _port;
+};
+
+#endif // FAKE_CAMERA_H
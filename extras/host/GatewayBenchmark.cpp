@@ -0,0 +1,124 @@
+/*
+GatewayBenchmark.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// Load benchmark of the gateway mode: many GoProControl, each with its own PosixTransport to a
+// fake camera on its own loopback address, driven by pollAllStatus() and commandAll() from one
+// thread. Every camera answers after 20 to 120 ms, like the access point of a HERO5.
+//
+//   make benchmark && ./build/GatewayBenchmark [cameras] [rounds]
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <FakeCamera.h>
+
+#include <algorithm>
+#include <vector>
+
+#define FAKE_PORT 8080
+#define DELAY_MIN 20
+#define DELAY_MAX 120
+#define TIMEOUT 2000
+
+static void printTimes(const char *name, std::vector<uint32_t> &times, const uint32_t requests)
+{
+    std::sort(times.begin(), times.end());
+    uint32_t total = 0;
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        total += times[i];
+    }
+    printf("%-14s p50 %4u ms  p90 %4u ms  max %4u ms  %6.0f requests/s\n", name,
+           times[times.size() / 2], times[times.size() * 9 / 10], times.back(),
+           total > 0 ? requests * 1000.0 / total : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    const int count = argc > 1 ? constrain(atoi(argv[1]), 1, 255) : 200;
+    const int rounds = argc > 2 ? max(atoi(argv[2]), 1) : 20;
+
+    FakeCameras fakes;
+    std::vector<FakeCameraTransport *> transports;
+    std::vector<GoProControl *> cameras;
+    for (int i = 0; i < count; i++)
+    {
+        char address[16];
+        snprintf(address, sizeof(address), "127.0.%d.%d", 1 + i / 200, 1 + i % 200);
+        if (fakes.add(address, FAKE_PORT, "HERO5 Black", DELAY_MIN, DELAY_MAX) < 0)
+        {
+            printf("can't listen on %s:%d\n", address, FAKE_PORT);
+            return 1;
+        }
+        transports.push_back(new FakeCameraTransport(address, FAKE_PORT));
+        cameras.push_back(new GoProControl("ssid", "password", HERO5));
+        cameras[i]->setTransport(transports[i]);
+        cameras[i]->begin();
+    }
+    fakes.start();
+
+    // every camera in flight at once
+    std::vector<GroupSlot> slots(count);
+    std::vector<CameraStatus> snapshot(count);
+    std::vector<uint8_t> results(count);
+    std::vector<uint32_t> status_times, shutter_times;
+    uint32_t answered = 0, accepted = 0;
+    for (int round = 0; round < rounds; round++)
+    {
+        uint32_t start = millis();
+        answered += GoProControl::pollAllStatus(cameras.data(), count, snapshot.data(), slots.data(), count, TIMEOUT);
+        status_times.push_back(millis() - start);
+
+        start = millis();
+        accepted += GoProControl::commandAll(cameras.data(), count, round % 2 ? CMD_SHUTTER_OFF : CMD_SHUTTER_ON,
+                                             results.data(), slots.data(), count, TIMEOUT);
+        shutter_times.push_back(millis() - start);
+    }
+
+    // the same status requests one camera after the other, on a few cameras
+    const int sequential = min(count, 10);
+    std::vector<uint32_t> sequential_times;
+    for (int i = 0; i < sequential; i++)
+    {
+        const uint32_t start = millis();
+        cameras[i]->isOn();
+        sequential_times.push_back(millis() - start);
+    }
+    uint32_t sequential_total = 0;
+    for (int i = 0; i < sequential; i++)
+    {
+        sequential_total += sequential_times[i];
+    }
+
+    printf("%d cameras, %d rounds, answers after %d to %d ms\n", count, rounds, DELAY_MIN, DELAY_MAX);
+    printf("status answered %u/%u, shutter accepted %u/%u\n", answered, count * rounds, accepted, count * rounds);
+    printf("time to the whole group:\n");
+    printTimes("pollAllStatus", status_times, answered);
+    printTimes("commandAll", shutter_times, accepted);
+    printf("one after the other: %u ms for %d cameras, about %u ms for %d\n",
+           sequential_total, sequential, sequential_total * count / sequential, count);
+
+    fakes.stop();
+    for (int i = 0; i < count; i++)
+    {
+        delete cameras[i];
+        delete transports[i];
+    }
+    return answered == (uint32_t)count * rounds && accepted == (uint32_t)count * rounds ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+/*
+WiFi.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL,
+    WL_SCAN_COMPLETED,
+    WL_CONNECTED,
+    WL_CONNECT_FAILED,
+    WL_CONNECTION_LOST,
+    WL_DISCONNECTED
+} wl_status_t;
+
+// On a computer the system joins the access points (NetworkManager, wpa_supplicant, one
+// interface per camera): WiFi is always connected and begin() doesn't do anything
+class WiFiClass
+{
+  public:
+    int begin(const char *, const char *) { return WL_CONNECTED; }
+    wl_status_t status() { return WL_CONNECTED; }
+    int disconnect(bool = false) { return 0; }
+    const char *SSID() { return ""; }
+    IPAddress localIP() { return IPAddress(); }
+    long RSSI() { return 0; }
+    uint8_t *macAddress(uint8_t *mac) { return mac; }
+    uint8_t *BSSID(uint8_t *bssid)
+    {
+        memset(bssid, 0, 6);
+        return bssid;
+    }
+};
+
+extern WiFiClass WiFi;
+
+// It never connects: on a computer give every GoProControl a PosixTransport with setTransport()
+class WiFiClient : public Client
+{
+  public:
+    int connect(IPAddress, uint16_t) { return 0; }
+    int connect(const char *, uint16_t) { return 0; }
+    size_t write(uint8_t) { return 0; }
+    size_t write(const uint8_t *, size_t) { return 0; }
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    int read(uint8_t *, size_t) { return -1; }
+    int peek() { return -1; }
+    void flush() {}
+    void stop() {}
+    uint8_t connected() { return 0; }
+    operator bool() { return false; }
+};
+
+#endif // HOST_WIFI_H
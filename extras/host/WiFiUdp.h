@@ -0,0 +1,48 @@
+/*
+WiFiUdp.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef HOST_WIFI_UDP_H
+#define HOST_WIFI_UDP_H
+
+#include <Udp.h>
+
+// Like WiFiClient it doesn't send anything, PosixTransport::sendDatagram() wakes the cameras
+class WiFiUDP : public UDP
+{
+  public:
+    uint8_t begin(uint16_t) { return 0; }
+    void stop() {}
+    int beginPacket(IPAddress, uint16_t) { return 0; }
+    int beginPacket(const char *, uint16_t) { return 0; }
+    int endPacket() { return 0; }
+    size_t write(uint8_t) { return 0; }
+    size_t write(const uint8_t *, size_t) { return 0; }
+    using Print::write;
+    int parsePacket() { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int read(unsigned char *, size_t) { return -1; }
+    int read(char *, size_t) { return -1; }
+    int peek() { return -1; }
+    IPAddress remoteIP() { return IPAddress(); }
+    uint16_t remotePort() { return 0; }
+};
+
+#endif // HOST_WIFI_UDP_H
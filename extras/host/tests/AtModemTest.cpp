@@ -0,0 +1,293 @@
+/*
+AtModemTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// EspAtClient against a scripted ESP01 on the other side of a pty: a request is one AT+CIPSEND,
+// the answer comes from the +IPD frames of our link only and the link stays open between requests
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <EspAtClient.h>
+#include <ClientTransport.h>
+#include "Check.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+// the UART of the board: the slave side of the pty
+class PtyStream : public Stream
+{
+  public:
+    int descriptor = -1;
+
+    int available()
+    {
+        fill();
+        return _peeked >= 0 ? 1 : 0;
+    }
+    int read()
+    {
+        fill();
+        const int c = _peeked;
+        _peeked = -1;
+        return c;
+    }
+    int peek()
+    {
+        fill();
+        return _peeked;
+    }
+    size_t write(uint8_t c) { return ::write(descriptor, &c, 1) == 1 ? 1 : 0; }
+    size_t write(const uint8_t *buffer, size_t size) { return max(::write(descriptor, buffer, size), (ssize_t)0); }
+    using Print::write;
+
+  private:
+    int _peeked = -1;
+
+    void fill()
+    {
+        uint8_t c;
+        if (_peeked < 0 && ::read(descriptor, &c, 1) == 1)
+        {
+            _peeked = c;
+        }
+    }
+};
+
+// the ESP01 with the AT firmware, on the master side of the pty
+class FakeModem
+{
+  public:
+    int descriptor = -1;
+    int cipmux = 0;
+    int cipstart = 0;
+    int cipsend = 0;
+    int cipclose = 0;
+    std::string payload; // the bytes of the last AT+CIPSEND
+    int split = 0;       // ms between the status line and the rest of the answer, 0 sends it in one frame
+
+    void start()
+    {
+        _running = true;
+        _thread = std::thread(&FakeModem::serve, this);
+    }
+    void stop()
+    {
+        _running = false;
+        _thread.join();
+    }
+
+  private:
+    std::thread _thread;
+    volatile bool _running = false;
+    std::string _line;
+    size_t _expected = 0; // payload bytes after the "> " prompt
+
+    void answer(const std::string &text) { ::write(descriptor, text.data(), text.size()); }
+
+    void serve()
+    {
+        while (_running)
+        {
+            pollfd master = {descriptor, POLLIN, 0};
+            char c;
+            if (poll(&master, 1, 10) <= 0 || ::read(descriptor, &c, 1) != 1)
+            {
+                continue;
+            }
+            if (_expected > 0)
+            {
+                payload += c;
+                if (payload.size() == _expected)
+                {
+                    _expected = 0;
+                    send();
+                }
+                continue;
+            }
+            _line += c;
+            if (_line.size() >= 2 && _line.compare(_line.size() - 2, 2, "\r\n") == 0)
+            {
+                command(_line.substr(0, _line.size() - 2));
+                _line.clear();
+            }
+        }
+    }
+
+    void command(const std::string &line)
+    {
+        if (line == "AT+CIPMUX=1")
+        {
+            cipmux++;
+            answer("\r\nOK\r\n");
+        }
+        else if (line == "AT+CIPSTART=4,\"TCP\",\"10.5.5.9\",80")
+        {
+            cipstart++;
+            answer("4,CONNECT\r\n\r\nOK\r\n");
+        }
+        else if (line.compare(0, 13, "AT+CIPSEND=4,") == 0)
+        {
+            cipsend++;
+            _expected = atoi(line.c_str() + 13);
+            payload.clear();
+            answer("\r\nOK\r\n> ");
+        }
+        else if (line == "AT+CIPCLOSE=4")
+        {
+            cipclose++;
+            answer("4,CLOSED\r\n\r\nOK\r\n");
+        }
+        else
+        {
+            answer("\r\nERROR\r\n");
+        }
+    }
+
+    // the answer of the camera on our link, then some data of the link of WiFiEsp
+    void send()
+    {
+        const std::string body = payload.find("/gp/gpControl/status") != std::string::npos
+                                     ? "{\"status\":{\"8\":0,\"43\":1,\"70\":64,\"35\":900},\"settings\":{}}"
+                                     : "{}";
+        const std::string http = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        answer("\r\nRecv " + std::to_string(payload.size()) + " bytes\r\n\r\nSEND OK\r\n");
+        if (split > 0)
+        {
+            const size_t line = http.find("\r\n") + 2;
+            answer("\r\n+IPD,4," + std::to_string(line) + ":" + http.substr(0, line) + "\r\n");
+            std::this_thread::sleep_for(std::chrono::milliseconds(split));
+            answer("\r\n+IPD,4," + std::to_string(http.size() - line) + ":" + http.substr(line) + "\r\n");
+        }
+        else
+        {
+            answer("\r\n+IPD,4," + std::to_string(http.size()) + ":" + http + "\r\n");
+        }
+        answer("\r\n+IPD,0,3:abc\r\n");
+    }
+};
+
+static std::string readAll(EspAtClient &client, const uint32_t wait)
+{
+    std::string text;
+    const uint32_t start = millis();
+    while (millis() - start < wait)
+    {
+        const int c = client.read();
+        if (c >= 0)
+        {
+            text += (char)c;
+        }
+    }
+    return text;
+}
+
+static std::string readLine(EspAtClient &client, const uint32_t wait)
+{
+    std::string text;
+    const uint32_t start = millis();
+    while (millis() - start < wait && (text.size() < 2 || text.compare(text.size() - 2, 2, "\r\n") != 0))
+    {
+        const int c = client.read();
+        if (c >= 0)
+        {
+            text += (char)c;
+        }
+    }
+    return text;
+}
+
+int main()
+{
+    FakeModem modem;
+    PtyStream uart;
+    modem.descriptor = posix_openpt(O_RDWR | O_NOCTTY);
+    CHECK(modem.descriptor >= 0 && grantpt(modem.descriptor) == 0 && unlockpt(modem.descriptor) == 0);
+    uart.descriptor = open(ptsname(modem.descriptor), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    CHECK(uart.descriptor >= 0);
+    termios raw;
+    tcgetattr(uart.descriptor, &raw);
+    cfmakeraw(&raw);
+    tcsetattr(uart.descriptor, TCSANOW, &raw);
+    modem.start();
+
+    // the client alone
+    EspAtClient client;
+    CHECK(client.begin(uart) == true);
+    CHECK(modem.cipmux == 1);
+    const char request[] = "GET /gp/gpControl/command/shutter?p=1 HTTP/1.1\r\nHost: 10.5.5.9\r\n\r\n";
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        CHECK(client.connect("10.5.5.9", 80) == 1);
+        CHECK(client.write((const uint8_t *)request, strlen(request)) == strlen(request));
+        CHECK(modem.payload == request);
+        const std::string answer = readAll(client, 100);
+        CHECK(answer == "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n{}");
+        client.stop();
+    }
+    CHECK(modem.cipstart == 1); // kept open by stop()
+    CHECK(modem.cipsend == 2);
+    CHECK(modem.cipclose == 0);
+
+    // the whole library over it
+    WiFiUDP udp;
+    ClientTransport transport(client, udp);
+    GoProControl camera("ssid", "password", HERO5);
+    camera.setTransport(&transport);
+    CHECK(camera.begin() == true);
+    CHECK(camera.shoot() == true);
+    CHECK(modem.payload.compare(0, 38, "GET /gp/gpControl/command/shutter?p=1 ") == 0);
+    CHECK(camera.isOn() == true);
+    CHECK(camera.getStatus().battery == 64);
+    CHECK(modem.cipstart == 1);
+    CHECK(modem.cipsend == 4); // one per request
+
+    client.setKeepAlive(false);
+    client.stop();
+    CHECK(modem.cipclose == 1);
+    CHECK(client.connected() == 0);
+
+    // only the status line read while the rest is still coming: the link is closed, so the rest
+    // can't be taken for the answer to the next request
+    client.setKeepAlive(true);
+    modem.split = 50;
+    CHECK(client.connect("10.5.5.9", 80) == 1);
+    CHECK(client.write((const uint8_t *)request, strlen(request)) == strlen(request));
+    CHECK(readLine(client, 100) == "HTTP/1.1 200 OK\r\n");
+    client.stop();
+    CHECK(modem.cipclose == 2);
+    modem.split = 0;
+    CHECK(client.connect("10.5.5.9", 80) == 1);
+    CHECK(modem.cipstart == 3);
+    CHECK(client.write((const uint8_t *)request, strlen(request)) == strlen(request));
+    CHECK(readAll(client, 100) == "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n{}");
+    client.stop();
+    CHECK(modem.cipclose == 2); // the whole answer arrived, kept
+
+    modem.stop();
+    close(uart.descriptor);
+    close(modem.descriptor);
+    return CHECK_RESULT();
+}
@@ -0,0 +1,181 @@
+/*
+BleTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// BleControl and the BLE commands of GoProControl against a fake GATT peer: the peer notifies
+// its answers from its own thread after a delay, like the task of a Bluetooth stack
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include "Check.h"
+
+#include <atomic>
+#include <thread>
+
+#define ANSWER_DELAY 40
+
+// the camera: every command frame gets <2> <command id> <status> after ANSWER_DELAY ms
+class FakeGattPeer : public BleLink
+{
+  public:
+    std::atomic<bool> up{false};
+    std::atomic<uint8_t> status{0};
+    std::atomic<bool> silent{false};
+    std::atomic<bool> other_answer_first{false}; // notify an answer of another command before
+    uint8_t frame[BleControl::frame_size];
+    size_t frame_size = 0;
+    uint32_t writes = 0;
+
+    ~FakeGattPeer() { join(); }
+
+    bool connect(const uint32_t) { return up = true; }
+    bool connected() { return up; }
+    void disconnect() { up = false; }
+
+    bool writeCommand(const uint8_t *data, const size_t size)
+    {
+        join();
+        memcpy(frame, data, size);
+        frame_size = size;
+        writes++;
+        if (!silent)
+        {
+            const uint8_t id = data[1];
+            _notifier = std::thread([this, id]() {
+                delay(ANSWER_DELAY);
+                if (other_answer_first)
+                {
+                    const uint8_t other[] = {2, (uint8_t)(id + 1), 0};
+                    response(other, sizeof(other));
+                }
+                const uint8_t answer[] = {2, id, status};
+                response(answer, sizeof(answer));
+            });
+        }
+        return true;
+    }
+
+    bool sent(const uint8_t command[], const size_t size)
+    {
+        return frame_size == size + 1 && frame[0] == size && memcmp(frame + 1, command, size) == 0;
+    }
+
+    void join()
+    {
+        if (_notifier.joinable())
+        {
+            _notifier.join();
+        }
+    }
+
+  private:
+    std::thread _notifier;
+};
+
+static std::atomic<int> done_calls{0};
+static std::atomic<uint8_t> done_result{0};
+
+static void onDone(void *, const uint8_t result)
+{
+    done_calls++;
+    done_result = result;
+}
+
+static bool waitDone(BleControl &control)
+{
+    const uint32_t start = millis();
+    while (control.pending() && millis() - start < 500)
+    {
+        delay(1);
+    }
+    return !control.pending();
+}
+
+int main()
+{
+    FakeGattPeer peer;
+    peer.connect(0);
+
+    // the request only writes, the notification completes it
+    BleControl control;
+    control.setLink(&peer);
+    control.onDone(onDone, NULL);
+    uint32_t start = millis();
+    CHECK(control.request(BLE_RecordStart, sizeof(BLE_RecordStart)));
+    CHECK(millis() - start < ANSWER_DELAY / 2);
+    CHECK(control.pending());
+    CHECK(control.result() == false);
+    CHECK(!control.request(BLE_RecordStop, sizeof(BLE_RecordStop))); // one at a time
+    CHECK(peer.sent(BLE_RecordStart, sizeof(BLE_RecordStart)));
+    CHECK(waitDone(control));
+    CHECK(millis() - start >= ANSWER_DELAY);
+    CHECK(control.result() == true);
+    CHECK(done_calls == 1 && done_result == true);
+
+    // refused, and an answer of another command doesn't complete it
+    peer.status = 2;
+    peer.other_answer_first = true;
+    CHECK(control.request(BLE_RecordStop, sizeof(BLE_RecordStop)));
+    CHECK(waitDone(control));
+    CHECK(control.result() == (uint8_t)-1);
+    CHECK(control.status() == 2);
+    CHECK(done_calls == 2 && done_result == (uint8_t)-1);
+    peer.status = 0;
+    peer.other_answer_first = false;
+
+    // cancelled: the late answer is forgotten
+    CHECK(control.request(BLE_ModeVideo, sizeof(BLE_ModeVideo)));
+    control.cancel();
+    peer.join();
+    CHECK(control.result() == false);
+    CHECK(done_calls == 2);
+    control.setLink(NULL);
+
+    // GoProControl over the fake peer
+    GoProControl camera("ssid", "password", HERO5);
+    camera.setBleLink(&peer);
+    CHECK(camera.enableBLE() == true);
+    CHECK(camera.wifiOff() == true);
+    CHECK(peer.sent(BLE_WiFiOff, sizeof(BLE_WiFiOff)));
+    CHECK(camera.shoot() == true);
+    CHECK(peer.sent(BLE_RecordStart, sizeof(BLE_RecordStart)));
+    CHECK(camera.lastRoundTrip() >= ANSWER_DELAY);
+    CHECK(camera.setMode(MULTISHOT_MODE) == true);
+    CHECK(peer.sent(BLE_ModeMultiShot, sizeof(BLE_ModeMultiShot)));
+
+    peer.status = 2;
+    CHECK(camera.stopShoot() == (uint8_t)-1);
+    CHECK(peer.sent(BLE_RecordStop, sizeof(BLE_RecordStop)));
+    peer.status = 0;
+
+    peer.silent = true;
+    CHECK(camera.setMode(PHOTO_MODE) == false);
+    peer.silent = false;
+    CHECK(camera.setMode(PHOTO_MODE) == true); // the missed answer doesn't block the next one
+
+    const uint32_t writes = peer.writes;
+    CHECK(camera.disableBLE() == false); // the WiFi is off, it would lose the camera
+    CHECK(peer.writes == writes);
+    CHECK(camera.wifiOn() == true);
+    CHECK(peer.sent(BLE_WiFiOn, sizeof(BLE_WiFiOn)));
+    CHECK(camera.disableBLE() == true);
+    CHECK(!peer.connected());
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,100 @@
+/*
+GroupTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// pollAllStatus() and commandAll() against fake cameras on loopback, each one a GoProControl
+// with its own transport: the group takes as long as the slowest camera, not the sum
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <FakeCamera.h>
+#include "Check.h"
+
+#define CAMERAS 4
+#define PORT 8081
+
+static const uint16_t DELAYS[CAMERAS] = {100, 200, 300, 50}; // 650 ms one after the other
+
+int main()
+{
+    FakeCameras fakes;
+    FakeCameraTransport transports[CAMERAS];
+    GoProControl *cameras[CAMERAS];
+    for (uint8_t i = 0; i < CAMERAS; i++)
+    {
+        char address[16];
+        snprintf(address, sizeof(address), "127.0.2.%d", i + 1);
+        CHECK(fakes.add(address, PORT, "HERO5 Black", DELAYS[i], DELAYS[i], i == 3) == i);
+        fakes.setStatus(i, i % 2, i, 50 + i, 1000 * i);
+        transports[i].reach(address, PORT);
+        cameras[i] = new GoProControl("ssid", "password", HERO5);
+        cameras[i]->setTransport(&transports[i]);
+        cameras[i]->begin();
+    }
+    fakes.start();
+
+    // all at once, the fourth camera never answers
+    GroupSlot slots[CAMERAS];
+    CameraStatus snapshot[CAMERAS];
+    uint32_t start = millis();
+    CHECK(GoProControl::pollAllStatus(cameras, CAMERAS, snapshot, slots, CAMERAS, 500) == 3);
+    const uint32_t took = millis() - start;
+    CHECK(took >= 300 && took < 600);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        CHECK(snapshot[i].code == 200);
+        CHECK(snapshot[i].round_trip >= DELAYS[i]);
+        CHECK(snapshot[i].recording == i % 2);
+        CHECK(snapshot[i].mode == i);
+        CHECK(snapshot[i].battery == 50 + i);
+        CHECK(snapshot[i].video_left == 1000 * i);
+    }
+    CHECK(snapshot[3].code == 0);
+    CHECK(snapshot[3].battery == -1);
+    CHECK(fakes.lastPath(3) == "/gp/gpControl/status");
+
+    // two slots: two groups of two, 200 + 300 ms
+    start = millis();
+    CHECK(GoProControl::pollAllStatus(cameras, 3, snapshot, slots, 2, 1000) == 3);
+    CHECK(millis() - start < 650);
+    CHECK(snapshot[2].code == 200 && snapshot[2].battery == 52);
+
+    uint8_t results[CAMERAS];
+    CHECK(GoProControl::commandAll(cameras, 3, CMD_SHUTTER_ON, results, slots, CAMERAS, 1000) == 3);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        CHECK(results[i] == true);
+        CHECK(fakes.lastPath(i) == "/gp/gpControl/command/shutter?p=1");
+        CHECK(fakes.requests(i) == 3);
+    }
+
+    // without slots nothing is asked, and it returns instead of looping forever
+    CHECK(GoProControl::pollAllStatus(cameras, 3, snapshot, slots, 0, 1000) == 0);
+    CHECK(GoProControl::pollAllStatus(cameras, 3, snapshot, NULL, CAMERAS, 1000) == 0);
+    CHECK(GoProControl::commandAll(cameras, 3, CMD_SHUTTER_ON, results, slots, 0, 1000) == 0);
+    CHECK(GoProControl::commandAll(cameras, 3, CMD_SHUTTER_ON, results, NULL, CAMERAS, 1000) == 0);
+    CHECK(fakes.requests(0) == 3);
+
+    fakes.stop();
+    for (uint8_t i = 0; i < CAMERAS; i++)
+    {
+        delete cameras[i];
+    }
+    return CHECK_RESULT();
+}
@@ -0,0 +1,90 @@
+/*
+HeapCount.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef HEAP_COUNT_H
+#define HEAP_COUNT_H
+
+#include <stdlib.h>
+#include <new>
+
+// Counts the allocations of the thread that sets heap_counting, not of the fake cameras serving
+// it: new everywhere, malloc(), calloc() and realloc() too with glibc. Include it in one file of
+// the test only
+static long heap_allocations = 0;
+static thread_local bool heap_counting = false;
+
+#if defined(__GLIBC__)
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    heap_allocations += heap_counting;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    heap_allocations += heap_counting;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    heap_allocations += heap_counting;
+    return __libc_realloc(pointer, size);
+}
+#endif
+
+// noinline: inlined, gcc sees free() of what new returned and warns
+__attribute__((noinline)) void *operator new(size_t size)
+{
+#if !defined(__GLIBC__) // else malloc() counts it
+    heap_allocations += heap_counting;
+#endif
+    void *pointer = malloc(size);
+    if (pointer == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    free(pointer);
+}
+
+// the allocations made by the statements between the two macros
+#define HEAP_COUNT_START() (heap_allocations = 0, heap_counting = true)
+#define HEAP_COUNT_STOP() (heap_counting = false, heap_allocations)
+
+#endif // HEAP_COUNT_H
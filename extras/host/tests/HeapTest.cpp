@@ -0,0 +1,79 @@
+/*
+HeapTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// The credentials stay where the sketch keeps them (RAM or flash with F()): building a camera
+// and sending its commands, HERO3 password included, doesn't allocate anything
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <FakeCamera.h>
+#include "Check.h"
+#include "HeapCount.h"
+
+#define PORT 8084
+
+static const char SSID[] = "camera";
+static const char PASSWORD[] = "password";
+
+int main()
+{
+    FakeCameras fakes;
+    CHECK(fakes.add("127.0.5.1", PORT, "HERO5 Black") == 0);
+    CHECK(fakes.add("127.0.5.2", PORT, "HERO3") == 1);
+    fakes.start();
+    FakeCameraTransport hero5_transport("127.0.5.1", PORT);
+    FakeCameraTransport hero3_transport("127.0.5.2", PORT);
+
+    HEAP_COUNT_START();
+    GoProControl hero5(SSID, PASSWORD, HERO5);
+    GoProControl hero3(F("hero3"), F("secret"), HERO3);
+    CHECK(HEAP_COUNT_STOP() == 0);
+
+    hero5.setTransport(&hero5_transport);
+    hero3.setTransport(&hero3_transport);
+    CHECK(hero5.begin() == true);
+    CHECK(hero3.begin() == true);
+
+    HEAP_COUNT_START();
+    CHECK(hero5.shoot() == true);
+    CHECK(hero5.stopShoot() == true);
+    CHECK(hero5.setMode(PHOTO_MODE) == true);
+    CHECK(hero5.setVideoResolution(VR_1080p) == true);
+    CHECK(hero5.isOn() == true);
+    CHECK(hero3.shoot() == true);
+    CHECK(hero3.stopShoot() == true);
+    CHECK(hero3.setMode(PHOTO_MODE) == true);
+    CHECK(HEAP_COUNT_STOP() == 0);
+    CHECK(hero5.getStatus().battery == 87);
+    CHECK(fakes.lastPath(1) == "/camera/CM?t=secret&p=%01");
+
+    // the group requests work in the slots of the caller
+    static GroupSlot slots[2];
+    GoProControl *cameras[] = {&hero5, &hero3};
+    CameraStatus snapshot[2];
+    uint8_t results[2];
+    HEAP_COUNT_START();
+    CHECK(GoProControl::pollAllStatus(cameras, 1, snapshot, slots, 2) == 1);
+    CHECK(GoProControl::commandAll(cameras, 2, CMD_SHUTTER_OFF, results, slots, 2) == 2);
+    CHECK(HEAP_COUNT_STOP() == 0);
+
+    fakes.stop();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,131 @@
+/*
+MacTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// The MAC addresses are fixed arrays inside GoProControl: 20 cameras are built without a single
+// allocation, the wake on lan packet comes from the copy of the MAC and end() keeps a given one
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <FakeCamera.h>
+#include "Check.h"
+#include "HeapCount.h"
+
+#define CAMERAS 20
+
+static constexpr uint8_t NO_MAC[MAC_SIZE] = {0, 0, 0, 0, 0, 0};
+static constexpr uint8_t CAMERA_MAC[MAC_SIZE] = {0x04, 0x41, 0x69, 0xaa, 0xbb, 0xcc};
+static_assert(macIsEmpty(NO_MAC) && !macIsEmpty(CAMERA_MAC), "macIsEmpty() is constexpr");
+static_assert(WOL_PACKET_SIZE == 102, "6 times 0xFF and 16 times the mac");
+
+// keeps the wake on lan packets instead of sending them
+class WakeOnLanTransport : public FakeCameraTransport
+{
+  public:
+    uint8_t packet[WOL_PACKET_SIZE + 1];
+    size_t size = 0;
+    uint16_t port = 0;
+    uint32_t sent = 0;
+
+    bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size)
+    {
+        this->size = min(size, sizeof(packet));
+        this->port = port;
+        memcpy(packet, buffer, this->size);
+        sent++;
+        return true;
+    }
+};
+
+static bool isWakeOnLan(const WakeOnLanTransport &transport, const uint8_t mac[])
+{
+    if (transport.size != WOL_PACKET_SIZE || transport.port != 9)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        if (transport.packet[i] != 0xFF)
+        {
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        if (memcmp(transport.packet + 6 + i * MAC_SIZE, mac, MAC_SIZE) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    HEAP_COUNT_START();
+    delete new int;
+    CHECK(HEAP_COUNT_STOP() == 1); // the counter works
+
+    // a rig of cameras, without the heap
+    alignas(GoProControl) static uint8_t storage[CAMERAS][sizeof(GoProControl)];
+    GoProControl *cameras[CAMERAS];
+    uint8_t mac[MAC_SIZE];
+    macCopy(mac, CAMERA_MAC);
+    HEAP_COUNT_START();
+    for (uint8_t i = 0; i < CAMERAS; i++)
+    {
+        mac[MAC_SIZE - 1] = i;
+        cameras[i] = new (storage[i]) GoProControl("ssid", "password", HERO5, mac);
+    }
+    CHECK(HEAP_COUNT_STOP() == 0);
+
+    // the camera keeps its own copy of the MAC it was given
+    WakeOnLanTransport transport;
+    cameras[7]->setTransport(&transport);
+    mac[MAC_SIZE - 1] = 7;
+    uint8_t given[MAC_SIZE];
+    macCopy(given, mac);
+    macClear(mac);
+    CHECK(cameras[7]->begin() == true);
+    HEAP_COUNT_START();
+    CHECK(cameras[7]->turnOn() == true);
+    CHECK(HEAP_COUNT_STOP() == 0);
+    CHECK(isWakeOnLan(transport, given));
+
+    // end() forgets what it learned from the access point, not what it was given
+    cameras[7]->end();
+    CHECK(cameras[7]->begin() == true);
+    transport.size = 0;
+    CHECK(cameras[7]->turnOn() == true);
+    CHECK(isWakeOnLan(transport, given));
+
+    // no MAC and none from the access point: nothing to send
+    WakeOnLanTransport unknown;
+    GoProControl camera("ssid", "password", HERO5);
+    camera.setTransport(&unknown);
+    CHECK(camera.begin() == true);
+    CHECK(camera.turnOn() == false);
+    CHECK(unknown.sent == 0);
+
+    for (uint8_t i = 0; i < CAMERAS; i++)
+    {
+        cameras[i]->~GoProControl();
+    }
+    return CHECK_RESULT();
+}
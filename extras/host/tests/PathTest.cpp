@@ -0,0 +1,115 @@
+/*
+PathTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// The requests of both dialects as a fake camera receives them: the HERO3 paths with the
+// password fragment built once in the constructor, the gpControl paths of HERO4 and newer
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <FakeCamera.h>
+#include "Check.h"
+
+#define PORT 8083
+
+struct Request
+{
+    uint8_t (*send)(GoProControl &camera);
+    const char *path;
+};
+
+static const Request HERO3_REQUESTS[] = {
+    {[](GoProControl &c) { return c.shoot(); }, "/bacpac/SH?t=secret&p=%01"},
+    {[](GoProControl &c) { return c.stopShoot(); }, "/bacpac/SH?t=secret&p=%00"},
+    {[](GoProControl &c) { return c.localizationOn(); }, "/camera/LL?t=secret&p=%01"},
+    {[](GoProControl &c) { return c.localizationOff(); }, "/camera/LL?t=secret&p=%00"},
+    {[](GoProControl &c) { return c.deleteLast(); }, "/camera/DL?t=secret"},
+    {[](GoProControl &c) { return c.deleteAll(); }, "/camera/DA?t=secret"},
+    {[](GoProControl &c) { return c.setMode(PHOTO_MODE); }, "/camera/CM?t=secret&p=%01"},
+    {[](GoProControl &c) { return c.setOrientation(ORIENTATION_DOWN); }, "/camera/UP?t=secret&p=%01"},
+    {[](GoProControl &c) { return c.setVideoResolution(VR_1080p); }, "/camera/VR?t=secret&p=%06"},
+    {[](GoProControl &c) { return c.setVideoFov(NARROW_FOV); }, "/camera/FV?t=secret&p=%02"},
+    {[](GoProControl &c) { return c.setFrameRate(FR_30); }, "/camera/FS?t=secret&p=%04"},
+    {[](GoProControl &c) { return c.setVideoEncoding(PAL); }, "/camera/VM?t=secret&p=%01"},
+    {[](GoProControl &c) { return c.setPhotoResolution(PR_5MP_WIDE); }, "/camera/PR?t=secret&p=%02"},
+    {[](GoProControl &c) { return c.setTimeLapseInterval(60); }, "/camera/TI?t=secret&p=%3c"},
+    {[](GoProControl &c) { return c.setContinuousShot(10); }, "/camera/CS?t=secret&p=%0a"},
+};
+
+static const Request GPCONTROL_REQUESTS[] = {
+    {[](GoProControl &c) { return c.shoot(); }, "/gp/gpControl/command/shutter?p=1"},
+    {[](GoProControl &c) { return c.stopShoot(); }, "/gp/gpControl/command/shutter?p=0"},
+    {[](GoProControl &c) { return c.localizationOn(); }, "/gp/gpControl/command/system/locate?p=1"},
+    {[](GoProControl &c) { return c.deleteLast(); }, "/gp/gpControl/command/storage/delete/last"},
+    {[](GoProControl &c) { return c.deleteAll(); }, "/gp/gpControl/command/storage/delete/all"},
+    {[](GoProControl &c) { return c.setMode(PHOTO_MODE); }, "/gp/gpControl/command/mode?p=1"},
+    {[](GoProControl &c) { return c.setMode(MULTISHOT_BURST_MODE); }, "/gp/gpControl/command/sub_mode?mode=2&sub_mode=0"},
+    {[](GoProControl &c) { return c.setOrientation(ORIENTATION_AUTO); }, "/gp/gpControl/setting/52/2"},
+    {[](GoProControl &c) { return c.setVideoResolution(VR_1080p); }, "/gp/gpControl/setting/2/9"},
+    {[](GoProControl &c) { return c.setVideoFov(LINEAR_FOV); }, "/gp/gpControl/setting/4/4"},
+    {[](GoProControl &c) { return c.setFrameRate(FR_60); }, "/gp/gpControl/setting/3/5"},
+    {[](GoProControl &c) { return c.setVideoEncoding(PAL); }, "/gp/gpControl/setting/57/1"},
+    {[](GoProControl &c) { return c.setPhotoResolution(PR_12MP_LINEAR); }, "/gp/gpControl/setting/17/10"},
+    {[](GoProControl &c) { return c.setTimeLapseInterval(60); }, "/gp/gpControl/setting/5/6"},
+};
+
+static void checkRequests(FakeCameras &fakes, const int fake, const uint8_t model, const Request requests[], const uint8_t count)
+{
+    FakeCameraTransport transport("127.0.4.1", PORT);
+    GoProControl camera("ssid", "secret", model);
+    camera.setTransport(&transport);
+    CHECK(camera.begin() == true);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const uint32_t before = fakes.requests(fake);
+        CHECK(requests[i].send(camera) == true);
+        CHECK(fakes.requests(fake) == before + 1);
+        if (fakes.lastPath(fake) != requests[i].path)
+        {
+            printf("got %s instead of %s\n", fakes.lastPath(fake).c_str(), requests[i].path);
+            CHECK(fakes.lastPath(fake) == requests[i].path);
+        }
+    }
+
+    // an option the camera doesn't have never leaves the board
+    const uint32_t before = fakes.requests(fake);
+    CHECK(camera.setTimeLapseInterval(2) == (uint8_t)-1);
+    CHECK(camera.setContinuousShot(model == HERO3 ? 7 : 10) == (model == HERO3 ? (uint8_t)-1 : false));
+    CHECK(fakes.requests(fake) == before);
+}
+
+int main()
+{
+    FakeCameras fakes;
+    CHECK(fakes.add("127.0.4.1", PORT) == 0);
+    fakes.start();
+
+    checkRequests(fakes, 0, HERO3, HERO3_REQUESTS, sizeof(HERO3_REQUESTS) / sizeof(Request));
+    checkRequests(fakes, 0, HERO5, GPCONTROL_REQUESTS, sizeof(GPCONTROL_REQUESTS) / sizeof(Request));
+
+    // the whole password fits in HERO3_AUTH_SIZE, a longer one makes begin() refuse the camera
+    char password[HERO3_AUTH_SIZE + 8];
+    memset(password, 'x', sizeof(password) - 1);
+    password[sizeof(password) - 1] = '\0';
+    GoProControl camera("ssid", password, HERO3);
+    CHECK(camera.begin() == (uint8_t)-1);
+
+    fakes.stop();
+    return CHECK_RESULT();
+}
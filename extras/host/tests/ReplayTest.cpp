@@ -0,0 +1,130 @@
+/*
+ReplayTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// A session with a fake camera is recorded with startRecording(), then played back by
+// ReplayTransport: the same commands get the same answers, at the recorded speed or at once,
+// and a command that wasn't recorded is a mismatch
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <ReplayTransport.h>
+#include <FakeCamera.h>
+#include "Check.h"
+
+#define PORT 8082
+#define DELAY 120
+
+// the transcript, in memory instead of a file
+class Transcript : public Print
+{
+  public:
+    uint8_t data[8192];
+    size_t size = 0;
+
+    size_t write(uint8_t c)
+    {
+        if (size == sizeof(data))
+        {
+            return 0;
+        }
+        data[size++] = c;
+        return 1;
+    }
+};
+
+static void session(GoProControl &camera, uint8_t results[3])
+{
+    results[0] = camera.isOn();
+    results[1] = camera.shoot();
+    results[2] = camera.setVideoResolution(VR_1080p);
+}
+
+int main()
+{
+    FakeCameras fakes;
+    CHECK(fakes.add("127.0.3.1", PORT, "HERO5 Black", DELAY, DELAY) == 0);
+    fakes.setStatus(0, 1, 2, 55, 777);
+    fakes.start();
+
+    FakeCameraTransport transport("127.0.3.1", PORT);
+    Transcript transcript;
+    GoProControl recorded("ssid", "password", HERO5);
+    recorded.setTransport(&transport);
+    recorded.begin();
+    recorded.startRecording(transcript);
+    uint8_t expected[3];
+    uint32_t start = millis();
+    session(recorded, expected);
+    const uint32_t recorded_time = millis() - start;
+    recorded.stopRecording();
+    fakes.stop();
+
+    CHECK(expected[0] == true && expected[1] == true && expected[2] == true);
+    CHECK(recorded.getStatus().battery == 55);
+    CHECK(recorded_time >= 3 * DELAY);
+    CHECK(transcript.size > 0 && transcript.size < sizeof(transcript.data));
+
+    // at the recorded speed, then as fast as possible
+    const float speeds[] = {1, 0};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        ReplayTransport replay(transcript.data, transcript.size, speeds[i]);
+        CHECK(replay.valid());
+        GoProControl camera("ssid", "password", HERO5);
+        camera.setTransport(&replay);
+        camera.begin();
+        replay.rewind();
+
+        uint8_t results[3];
+        start = millis();
+        session(camera, results);
+        const uint32_t took = millis() - start;
+        CHECK(memcmp(results, expected, sizeof(results)) == 0);
+        CHECK(camera.getStatus().battery == 55);
+        CHECK(camera.getStatus().recording == 1);
+        CHECK(replay.finished());
+        CHECK(!replay.mismatch());
+        if (speeds[i] == 1)
+        {
+            CHECK(took + 30 >= recorded_time && took < recorded_time + 100);
+            CHECK(camera.lastRoundTrip() >= DELAY);
+        }
+        else
+        {
+            CHECK(took < DELAY);
+        }
+    }
+
+    // another command than the recorded one
+    ReplayTransport replay(transcript.data, transcript.size, 0);
+    GoProControl camera("ssid", "password", HERO5);
+    camera.setTransport(&replay);
+    camera.begin();
+    replay.rewind();
+    camera.isOn();
+    CHECK(!replay.mismatch());
+    const size_t second = replay.position();
+    camera.stopShoot();
+    CHECK(replay.mismatch());
+    CHECK(replay.position() > second); // the connection matched, the request didn't
+    CHECK(!replay.finished());
+
+    return CHECK_RESULT();
+}
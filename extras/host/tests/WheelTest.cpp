@@ -0,0 +1,73 @@
+/*
+WheelTest.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+// TimerWheel keeps counting the cameras it ever took in a uint8_t for their phase: after 256
+// add() and remove() the wheel still runs and the camera added last is still kept alive
+
+#include <Arduino.h>
+#include <GoProControl.h>
+#include <TimerWheel.h>
+#include "Check.h"
+
+int main()
+{
+    TimerWheel wheel;
+    GoProControl camera("ssid", "password", HERO5);
+    GoProControl other("ssid", "password", HERO5);
+
+    CHECK(wheel.handle() == 0); // nothing added, the clock isn't running
+
+    // 255 cameras in and out, the 256th stays: the count of the added ones is back to 0
+    for (uint16_t i = 0; i < 255; i++)
+    {
+        const uint8_t timer = wheel.add(other);
+        CHECK(timer != TimerWheel::NONE);
+        wheel.remove(timer);
+    }
+    const uint8_t timer = wheel.add(camera);
+    CHECK(timer != TimerWheel::NONE);
+
+    // due after nextKeepAlive() and its share of WHEEL_STAGGER
+    uint16_t due = 0;
+    const uint32_t start = millis();
+    while (millis() - start < KEEP_ALIVE + WHEEL_STAGGER + 2 * WHEEL_TICK && due == 0)
+    {
+        due += wheel.handle();
+        delay(1);
+    }
+    CHECK(due == 1);
+
+    // one more goes in without moving the clock of the wheel back
+    const uint8_t second = wheel.add(other);
+    CHECK(second != TimerWheel::NONE && second != timer);
+    due = 0;
+    const uint32_t again = millis();
+    while (millis() - again < KEEP_ALIVE + WHEEL_STAGGER + 2 * WHEEL_TICK)
+    {
+        due += wheel.handle();
+        delay(1);
+    }
+    CHECK(due >= 2);
+    wheel.remove(timer);
+    wheel.remove(second);
+
+    return CHECK_RESULT();
+}
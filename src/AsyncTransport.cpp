@@ -0,0 +1,223 @@
+/*
+AsyncTransport.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <GoProControl.h>
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+
+AsyncTransport::AsyncTransport()
+{
+    _signal = xSemaphoreCreateBinary();
+    _client.setNoDelay(true);
+    _client.onConnect(onConnect, this);
+    _client.onData(onData, this);
+    _client.onDisconnect(onDisconnect, this);
+    _client.onError(onError, this);
+    _client.onTimeout(onTimeout, this);
+}
+
+AsyncTransport::~AsyncTransport()
+{
+    close();
+    vSemaphoreDelete(_signal);
+}
+
+bool AsyncTransport::connect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+    close();
+    xSemaphoreTake(_signal, 0); // forget old events
+
+    _connecting = true;
+    if (!_client.connect(host, port))
+    {
+        _connecting = false;
+        return false;
+    }
+
+    const uint32_t start_time = millis();
+    while (_connecting && millis() - start_time < timeout)
+    {
+        xSemaphoreTake(_signal, pdMS_TO_TICKS(timeout - (millis() - start_time)));
+    }
+
+    if (!_connected)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool AsyncTransport::connectAsync(const char *host, const uint16_t port, const uint32_t deadline, TransportEvent handler, void *arg)
+{
+    close();
+    _handler = handler;
+    _arg = arg;
+    _connecting = true;
+    _client.setRxTimeout((deadline + 999) / 1000);
+    if (!_client.connect(host, port))
+    {
+        _connecting = false;
+        _handler = NULL;
+        return false;
+    }
+    return true;
+}
+
+size_t AsyncTransport::write(const uint8_t *buffer, const size_t size)
+{
+    if (!_connected || _client.space() < size)
+    {
+        return 0;
+    }
+    const size_t added = _client.add((const char *)buffer, size);
+    _client.send();
+    return added;
+}
+
+int AsyncTransport::read(uint8_t *buffer, const size_t size)
+{
+    size_t count = 0;
+    portENTER_CRITICAL(&_lock);
+    while (count < size && _tail != _head)
+    {
+        buffer[count++] = _buffer[_tail];
+        _tail = (_tail + 1) % ASYNC_BUFFER_SIZE;
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    if (count == 0 && !_connected)
+    {
+        return -1;
+    }
+    return count;
+}
+
+void AsyncTransport::waitForData(const uint16_t timeout)
+{
+    if (_connected && _tail == _head)
+    {
+        xSemaphoreTake(_signal, pdMS_TO_TICKS(timeout));
+    }
+}
+
+bool AsyncTransport::connected()
+{
+    return _connected;
+}
+
+void AsyncTransport::close()
+{
+    _handler = NULL; // no more events, even if the close is reported later
+    if (_connected || _connecting)
+    {
+        _client.close(true);
+    }
+    _connected = false;
+    _connecting = false;
+    portENTER_CRITICAL(&_lock);
+    _head = _tail;
+    portEXIT_CRITICAL(&_lock);
+}
+
+bool AsyncTransport::sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size)
+{
+    _udp.begin(port);
+    const bool sent = _udp.beginPacket(host, port) && _udp.write(buffer, size) == size && _udp.endPacket();
+    _udp.stop();
+    return sent;
+}
+
+////////////////////////////////////////////////////////////
+////////                   Events                  /////////
+////////////////////////////////////////////////////////////
+
+// the connection is over, tell it once
+void AsyncTransport::closed()
+{
+    const bool was_open = _connected || _connecting;
+    _connected = false;
+    _connecting = false;
+    xSemaphoreGive(_signal);
+
+    TransportEvent handler = _handler;
+    _handler = NULL;
+    if (was_open && handler != NULL)
+    {
+        handler(_arg, TRANSPORT_CLOSED, NULL, 0);
+    }
+}
+
+void AsyncTransport::onConnect(void *arg, AsyncClient *client)
+{
+    AsyncTransport *transport = (AsyncTransport *)arg;
+    transport->_connected = true;
+    transport->_connecting = false;
+    xSemaphoreGive(transport->_signal);
+
+    if (transport->_handler != NULL)
+    {
+        transport->_handler(transport->_arg, TRANSPORT_CONNECTED, NULL, 0);
+    }
+}
+
+void AsyncTransport::onData(void *arg, AsyncClient *client, void *data, size_t size)
+{
+    AsyncTransport *transport = (AsyncTransport *)arg;
+
+    if (transport->_handler != NULL)
+    {
+        transport->_handler(transport->_arg, TRANSPORT_DATA, (const uint8_t *)data, size);
+        return;
+    }
+
+    // a full buffer loses the rest: ASYNC_BUFFER_SIZE is larger than the answers of the camera
+    const uint8_t *bytes = (const uint8_t *)data;
+    portENTER_CRITICAL(&transport->_lock);
+    for (size_t i = 0; i < size; i++)
+    {
+        const uint16_t next = (transport->_head + 1) % ASYNC_BUFFER_SIZE;
+        if (next == transport->_tail)
+        {
+            break;
+        }
+        transport->_buffer[transport->_head] = bytes[i];
+        transport->_head = next;
+    }
+    portEXIT_CRITICAL(&transport->_lock);
+    xSemaphoreGive(transport->_signal);
+}
+
+void AsyncTransport::onDisconnect(void *arg, AsyncClient *client)
+{
+    ((AsyncTransport *)arg)->closed();
+}
+
+void AsyncTransport::onError(void *arg, AsyncClient *client, int8_t error)
+{
+    ((AsyncTransport *)arg)->closed();
+}
+
+void AsyncTransport::onTimeout(void *arg, AsyncClient *client, uint32_t time)
+{
+    client->close(true);
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+AsyncTransport.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ASYNC_TRANSPORT_H
+#define ASYNC_TRANSPORT_H
+
+#include <Transport.h>
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <WiFiUdp.h>
+
+enum transport_event
+{
+    TRANSPORT_CONNECTED = 0,
+    TRANSPORT_DATA,
+    TRANSPORT_CLOSED // closed by the camera, by an error or by the rx timeout
+};
+
+// called from the AsyncTCP task
+typedef void (*TransportEvent)(void *arg, const uint8_t event, const uint8_t *data, const size_t size);
+
+// Transport on the AsyncTCP library (https://github.com/me-no-dev/AsyncTCP): lwIP calls us when
+// something happens instead of being polled. Used through the Transport interface the waits wake
+// up the moment the data arrives; with connectAsync() nothing waits at all, the events go to a
+// handler, so many cameras can have a command in flight at the same time
+class AsyncTransport : public Transport
+{
+  public:
+    AsyncTransport();
+    ~AsyncTransport();
+
+    bool connect(const char *host, const uint16_t port, const uint16_t timeout);
+    size_t write(const uint8_t *buffer, const size_t size);
+    int read(uint8_t *buffer, const size_t size);
+    void waitForData(const uint16_t timeout);
+    bool connected();
+    void close();
+    bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size);
+
+    // the data goes to the handler instead of the buffer, deadline in milliseconds without data
+    bool connectAsync(const char *host, const uint16_t port, const uint32_t deadline, TransportEvent handler, void *arg);
+
+  private:
+    AsyncClient _client;
+    WiFiUDP _udp;
+    SemaphoreHandle_t _signal; // given on every event, the blocking calls wait on it
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t _buffer[ASYNC_BUFFER_SIZE];
+    uint16_t _head = 0;
+    uint16_t _tail = 0;
+    volatile bool _connected = false;
+    volatile bool _connecting = false;
+    TransportEvent _handler = NULL;
+    void *_arg = NULL;
+
+    void closed();
+    static void onConnect(void *arg, AsyncClient *client);
+    static void onData(void *arg, AsyncClient *client, void *data, size_t size);
+    static void onDisconnect(void *arg, AsyncClient *client);
+    static void onError(void *arg, AsyncClient *client, int8_t error);
+    static void onTimeout(void *arg, AsyncClient *client, uint32_t time);
+};
+
+#endif
+
+#endif //ASYNC_TRANSPORT_H
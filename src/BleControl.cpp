@@ -0,0 +1,117 @@
+/*
+BleControl.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <BleControl.h>
+#include <string.h>
+
+BleControl::BleControl()
+{
+}
+
+void BleControl::setLink(BleLink *link)
+{
+    if (_link != NULL)
+    {
+        _link->onResponse(NULL, NULL);
+    }
+    cancel();
+    _link = link;
+    if (_link != NULL)
+    {
+        _link->onResponse(onResponse, this);
+    }
+}
+
+BleLink *BleControl::link()
+{
+    return _link;
+}
+
+bool BleControl::request(const uint8_t command[], const uint8_t size)
+{
+    if (_link == NULL || _pending || size == 0 || size >= frame_size || !_link->connected())
+    {
+        return false;
+    }
+
+    uint8_t frame[frame_size];
+    frame[0] = size;
+    memcpy(frame + 1, command, size);
+
+    _command_id = command[0];
+    _answered = false;
+    _pending = true; // before the write: the answer can arrive before writeCommand() returns
+    if (!_link->writeCommand(frame, size + 1))
+    {
+        _pending = false;
+        return false;
+    }
+    return true;
+}
+
+bool BleControl::pending()
+{
+    return _pending;
+}
+
+void BleControl::cancel()
+{
+    _pending = false;
+}
+
+uint8_t BleControl::result()
+{
+    if (!_answered)
+    {
+        return false;
+    }
+    return _status == 0 ? true : -1;
+}
+
+uint8_t BleControl::status()
+{
+    return _status;
+}
+
+void BleControl::onDone(BleDone callback, void *arg)
+{
+    _done = callback;
+    _done_arg = arg;
+}
+
+void BleControl::onResponse(void *arg, const uint8_t *data, const size_t size)
+{
+    BleControl *control = (BleControl *)arg;
+
+    // only the short answers of the commands: a header with the 5 bit length, then id and status
+    if (!control->_pending || size < 3 || (data[0] & 0xE0) != 0 || data[0] < 2 || data[1] != control->_command_id)
+    {
+        return;
+    }
+
+    control->_status = data[2];
+    control->_answered = true;
+    control->_pending = false;
+
+    if (control->_done != NULL)
+    {
+        control->_done(control->_done_arg, control->result());
+    }
+}
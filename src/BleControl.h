@@ -0,0 +1,62 @@
+/*
+BleControl.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BLE_CONTROL_H
+#define BLE_CONTROL_H
+
+#include <BleLink.h>
+
+// called when the answer arrives, with the same values of result()
+typedef void (*BleDone)(void *arg, const uint8_t result);
+
+// The command layer of the GoPro BLE protocol on a BleLink: a command is
+// <length> <command id> <parameters>, the camera notifies <length> <command id> <status>,
+// status 0 means done. request() only writes: the notification completes the request, there
+// is nothing to poll, pending() and onDone() tell when it happened
+class BleControl
+{
+  public:
+    static const uint8_t frame_size = 20; // a single write without MTU negotiation
+
+    BleControl();
+
+    void setLink(BleLink *link);
+    BleLink *link();
+
+    // command without the length byte, true if written
+    bool request(const uint8_t command[], const uint8_t size);
+    bool pending();
+    void cancel();     // stop waiting, the answer is forgotten
+    uint8_t result();  // true: done, -1: refused by the camera, false: no answer (yet)
+    uint8_t status();  // status byte of the last answer
+    void onDone(BleDone callback, void *arg);
+
+  private:
+    BleLink *_link = NULL;
+    volatile bool _pending = false;
+    volatile bool _answered = false;
+    volatile uint8_t _status = 0;
+    uint8_t _command_id = 0;
+    BleDone _done = NULL;
+    void *_done_arg = NULL;
+
+    static void onResponse(void *arg, const uint8_t *data, const size_t size);
+};
+
+#endif //BLE_CONTROL_H
@@ -0,0 +1,67 @@
+/*
+BleLink.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BLE_LINK_H
+#define BLE_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// called with every notification of the response characteristic, maybe from another task
+typedef void (*BleNotify)(void *arg, const uint8_t *data, const size_t size);
+
+// What GoProControl needs from Bluetooth: a GATT client connected to the GoPro service
+// (0000fea6-0000-1000-8000-00805f9b34fb) that writes the command characteristic
+// (b5f90072-aa8d-11e3-9046-0002a5d5c51b) and forwards the notifications of the response one
+// (b5f90073-aa8d-11e3-9046-0002a5d5c51b). Esp32BleLink is the one of the ESP32 BLE library,
+// anything else (another radio, a fake camera on a computer) can be given to setBleLink()
+class BleLink
+{
+  public:
+    virtual ~BleLink() {}
+
+    // find the camera, connect, pair and subscribe the responses, true within timeout milliseconds
+    virtual bool connect(const uint32_t timeout) = 0;
+    virtual bool connected() = 0;
+    virtual void disconnect() = 0;
+    // one write of the command characteristic, at most 20 bytes
+    virtual bool writeCommand(const uint8_t *data, const size_t size) = 0;
+
+    void onResponse(BleNotify callback, void *arg)
+    {
+        _notify = callback;
+        _notify_arg = arg;
+    }
+
+  protected:
+    // for the implementations, when a response notification arrives
+    void response(const uint8_t *data, const size_t size)
+    {
+        if (_notify != NULL)
+        {
+            _notify(_notify_arg, data, size);
+        }
+    }
+
+  private:
+    BleNotify _notify = NULL;
+    void *_notify_arg = NULL;
+};
+
+#endif //BLE_LINK_H
@@ -0,0 +1,234 @@
+/*
+Capabilities.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <GoProControl.h>
+#define LEN(x) ((sizeof(x) / sizeof(0 [x])) / ((size_t)(!(sizeof(x) % sizeof(0 [x])))))
+
+////////////////////////////////////////////////////////////
+////////                   Tables                   ////////
+////////////////////////////////////////////////////////////
+
+// the range of the options of each setting in Settings.h, time lapse and continuous shot are plain numbers
+static const uint8_t SETTING_RANGES[][2] PROGMEM = {
+    {mode_first, mode_last},
+    {orientation_first, orientation_last},
+    {video_resolution_first, video_resolution_last},
+    {video_fov_first, video_fov_last},
+    {frame_rate_first, frame_rate_last},
+    {video_encoding_first, video_encoding_last},
+    {photo_resolution_first, photo_resolution_last},
+};
+
+// options the dialect has but a model doesn't: {first camera with it, last camera with it, option}
+struct ModelRule
+{
+    uint8_t first;
+    uint8_t last;
+    uint8_t option;
+};
+
+static const ModelRule MODEL_RULES[] PROGMEM = {
+    {HERO5, FUSION, ORIENTATION_AUTO},
+    {HERO5, FUSION, LINEAR_FOV},
+    {HERO5, FUSION, VIDEO_TIMELAPSE_MODE},
+    {HERO4, HERO5, VIDEO_PHOTO_MODE},
+    {HERO7, FUSION, VIDEO_TIMEWARP_MODE},
+};
+
+#define FR(x) (1 << ((x) - frame_rate_first - 1))
+#define ALL_FRAME_RATES 0xFFFF
+
+// frame rates available at each video resolution, same order of video_resolution
+static const uint16_t HERO3_FRAME_RATES[video_resolution_last - video_resolution_first - 1] PROGMEM = {
+    FR(FR_15) | FR(FR_12p5) | FR(FR_12),                                       // VR_4K
+    FR(FR_30) | FR(FR_25),                                                     // VR_2K
+    0,                                                                         // VR_2K_SuperView
+    FR(FR_48) | FR(FR_30) | FR(FR_24),                                         // VR_1440p
+    0,                                                                         // VR_1080p_SuperView
+    FR(FR_60) | FR(FR_50) | FR(FR_48) | FR(FR_30) | FR(FR_25) | FR(FR_24),     // VR_1080p
+    FR(FR_100) | FR(FR_60) | FR(FR_50) | FR(FR_48),                            // VR_960p
+    0,                                                                         // VR_720p_SuperView
+    FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25),   // VR_720p
+    FR(FR_240),                                                                // VR_WVGA
+};
+
+static const uint16_t HERO4_FRAME_RATES[video_resolution_last - video_resolution_first - 1] PROGMEM = {
+    FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_60) | FR(FR_50) | FR(FR_48) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_80) | FR(FR_60) | FR(FR_50) | FR(FR_48) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_80) | FR(FR_60) | FR(FR_50) | FR(FR_48) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_120) | FR(FR_90) | FR(FR_60) | FR(FR_50) | FR(FR_48) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50),
+    FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50),
+    FR(FR_240) | FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25),
+    FR(FR_240),
+};
+
+static const uint16_t HERO5_FRAME_RATES[video_resolution_last - video_resolution_first - 1] PROGMEM = {
+    FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_80) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_80) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_120) | FR(FR_90) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50),
+    FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50),
+    FR(FR_240) | FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25),
+    FR(FR_240),
+};
+
+// HERO6 and HERO7: only the limits we are sure about, the rest is left to the camera
+static const uint16_t HERO6_FRAME_RATES[video_resolution_last - video_resolution_first - 1] PROGMEM = {
+    FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    FR(FR_120) | FR(FR_100) | FR(FR_60) | FR(FR_50) | FR(FR_30) | FR(FR_25) | FR(FR_24),
+    ALL_FRAME_RATES,
+    ALL_FRAME_RATES,
+    ALL_FRAME_RATES,
+    ALL_FRAME_RATES,
+    ALL_FRAME_RATES,
+    ALL_FRAME_RATES,
+};
+
+////////////////////////////////////////////////////////////
+////////                Capabilities                ////////
+////////////////////////////////////////////////////////////
+
+Capabilities::Capabilities()
+{
+    _camera = 0;
+    _frame_rates = NULL;
+    memset(_options, 0, CAPABILITY_SIZE);
+}
+
+void Capabilities::load(const uint8_t camera)
+{
+    _camera = camera;
+    memset(_options, 0, CAPABILITY_SIZE);
+
+    // start from everything the dialect can send
+    uint8_t options[photo_resolution_last];
+    for (uint8_t setting = 0; setting < LEN(SETTING_RANGES); setting++)
+    {
+        const uint8_t count = DIALECT(listOptions(setting, options, LEN(options)));
+        for (uint8_t i = 0; i < count; i++)
+        {
+            _options[options[i] / 8] |= 1 << (options[i] % 8);
+        }
+    }
+
+    // then remove what this model doesn't have
+    for (uint8_t i = 0; i < LEN(MODEL_RULES); i++)
+    {
+        const uint8_t first = pgm_read_byte(&MODEL_RULES[i].first);
+        const uint8_t last = pgm_read_byte(&MODEL_RULES[i].last);
+        if (camera < first || camera > last)
+        {
+            const uint8_t option = pgm_read_byte(&MODEL_RULES[i].option);
+            _options[option / 8] &= ~(1 << (option % 8));
+        }
+    }
+
+    if (camera == HERO3)
+    {
+        _frame_rates = HERO3_FRAME_RATES;
+    }
+    else if (camera == HERO4)
+    {
+        _frame_rates = HERO4_FRAME_RATES;
+    }
+    else if (camera == HERO5)
+    {
+        _frame_rates = HERO5_FRAME_RATES;
+    }
+    else if (camera == HERO6 || camera == HERO7)
+    {
+        _frame_rates = HERO6_FRAME_RATES;
+    }
+    else
+    {
+        _frame_rates = NULL; // unknown, don't check
+    }
+}
+
+bool Capabilities::supports(const uint8_t setting, const uint8_t option)
+{
+    if (_camera == 0 || setting >= setting_type_last)
+    {
+        return false;
+    }
+
+    if (setting >= LEN(SETTING_RANGES)) // plain numbers, a few entries in the dialect table
+    {
+        return DIALECT(hasOption(setting, option));
+    }
+
+    return option > pgm_read_byte(&SETTING_RANGES[setting][0]) &&
+           option < pgm_read_byte(&SETTING_RANGES[setting][1]) &&
+           isSet(option);
+}
+
+bool Capabilities::supportsFrameRate(const uint8_t resolution, const uint8_t frame_rate)
+{
+    if (!isSet(resolution) || !isSet(frame_rate) ||
+        resolution <= video_resolution_first || resolution >= video_resolution_last ||
+        frame_rate <= frame_rate_first || frame_rate >= frame_rate_last)
+    {
+        return false;
+    }
+
+    if (_frame_rates == NULL)
+    {
+        return true;
+    }
+
+    return pgm_read_word(&_frame_rates[resolution - video_resolution_first - 1]) & FR(frame_rate);
+}
+
+uint8_t Capabilities::list(const uint8_t setting, uint8_t options[], const uint8_t size)
+{
+    if (_camera == 0 || setting >= setting_type_last)
+    {
+        return 0;
+    }
+
+    if (setting >= LEN(SETTING_RANGES))
+    {
+        return DIALECT(listOptions(setting, options, size));
+    }
+
+    uint8_t count = 0;
+    const uint8_t last = pgm_read_byte(&SETTING_RANGES[setting][1]);
+    for (uint8_t option = pgm_read_byte(&SETTING_RANGES[setting][0]) + 1; option < last && count < size; option++)
+    {
+        if (isSet(option))
+        {
+            options[count++] = option;
+        }
+    }
+    return count;
+}
+
+bool Capabilities::isSet(const uint8_t option)
+{
+    return option < photo_resolution_last && (_options[option / 8] & (1 << (option % 8)));
+}
@@ -0,0 +1,49 @@
+/*
+Capabilities.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CAPABILITIES_H
+#define CAPABILITIES_H
+
+#include <Arduino.h>
+
+// one bit for every option of Settings.h, from mode_first to photo_resolution_last
+#define CAPABILITY_SIZE ((photo_resolution_last + 7) / 8)
+
+// What a camera model accepts: the options of its dialect minus the ones the model doesn't have,
+// and the frame rates available at each video resolution. load() builds a bitmap once, then every
+// check is a bit test so a wrong request is refused without a round trip to the camera
+class Capabilities
+{
+  public:
+    Capabilities();
+
+    void load(const uint8_t camera);
+    bool supports(const uint8_t setting, const uint8_t option);
+    bool supportsFrameRate(const uint8_t resolution, const uint8_t frame_rate);
+    uint8_t list(const uint8_t setting, uint8_t options[], const uint8_t size);
+
+  private:
+    uint8_t _camera;
+    uint8_t _options[CAPABILITY_SIZE];
+    const uint16_t *_frame_rates; // in flash, a bitmap of frame rates for each video resolution
+
+    bool isSet(const uint8_t option);
+};
+
+#endif //CAPABILITIES_H
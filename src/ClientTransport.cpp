@@ -0,0 +1,88 @@
+/*
+ClientTransport.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <ClientTransport.h>
+
+ClientTransport::ClientTransport(Client &client, UDP &udp) : _client(client), _udp(udp)
+{
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+ClientTransport::ClientTransport(WiFiClient &client, UDP &udp) : _client(client), _udp(udp)
+{
+    _wifi_client = &client;
+}
+#endif
+
+bool ClientTransport::connect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_wifi_client != NULL)
+    {
+        return _wifi_client->connect(host, port, timeout);
+    }
+#endif
+    // the Client API has no connect timeout: EspAtClient takes it from setTimeout(), the WiFi
+    // libraries of the other boards ignore it and use their own
+    _client.setTimeout(timeout);
+    return _client.connect(host, port);
+}
+
+size_t ClientTransport::write(const uint8_t *buffer, const size_t size)
+{
+    return _client.write(buffer, size);
+}
+
+int ClientTransport::read(uint8_t *buffer, const size_t size)
+{
+    const int available = _client.available();
+    if (available <= 0)
+    {
+        return _client.connected() ? 0 : -1;
+    }
+    return _client.read(buffer, min((size_t)available, size));
+}
+
+void ClientTransport::waitForData(const uint16_t timeout)
+{
+    const uint32_t start_time = millis();
+    while (_client.available() == 0 && _client.connected() && millis() - start_time < timeout)
+    {
+        delay(1);
+    }
+}
+
+bool ClientTransport::connected()
+{
+    return _client.connected();
+}
+
+void ClientTransport::close()
+{
+    _client.stop();
+}
+
+bool ClientTransport::sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size)
+{
+    _udp.begin(port);
+    const bool sent = _udp.beginPacket(host, port) && _udp.write(buffer, size) == size && _udp.endPacket();
+    _udp.stop();
+    return sent;
+}
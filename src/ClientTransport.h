@@ -0,0 +1,56 @@
+/*
+ClientTransport.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CLIENT_TRANSPORT_H
+#define CLIENT_TRANSPORT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <Udp.h>
+#include <Transport.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#endif
+
+// Transport on top of any Arduino Client and UDP: WiFiClient of every board, WiFiEspClient, EspAtClient
+class ClientTransport : public Transport
+{
+  public:
+    ClientTransport(Client &client, UDP &udp);
+#if defined(ARDUINO_ARCH_ESP32)
+    ClientTransport(WiFiClient &client, UDP &udp); // connect() with a real timeout
+#endif
+
+    bool connect(const char *host, const uint16_t port, const uint16_t timeout);
+    size_t write(const uint8_t *buffer, const size_t size);
+    int read(uint8_t *buffer, const size_t size);
+    void waitForData(const uint16_t timeout);
+    bool connected();
+    void close();
+    bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size);
+
+  private:
+    Client &_client;
+    UDP &_udp;
+#if defined(ARDUINO_ARCH_ESP32)
+    WiFiClient *_wifi_client = NULL;
+#endif
+};
+
+#endif //CLIENT_TRANSPORT_H
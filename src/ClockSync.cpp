@@ -0,0 +1,167 @@
+/*
+ClockSync.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <ClockSync.h>
+
+#define REQUEST_SIZE 9
+#define REPLY_SIZE 13
+
+ClockSync::ClockSync(const uint16_t port)
+{
+    _port = port;
+}
+
+////////////////////////////////////////////////////////////
+////////                   Master                   ////////
+////////////////////////////////////////////////////////////
+
+uint8_t ClockSync::beginMaster()
+{
+    _started = _udp.begin(_port);
+    return _started;
+}
+
+void ClockSync::handle()
+{
+    if (_started == false || _udp.parsePacket() < REQUEST_SIZE)
+    {
+        return;
+    }
+
+    const uint32_t now = millis();
+    uint8_t packet[REPLY_SIZE];
+    _udp.read(packet, REQUEST_SIZE);
+
+    if (packet[0] != 'G' || packet[1] != 'P' || packet[2] != 'S' || packet[3] != 'Q')
+    {
+        return;
+    }
+
+    packet[3] = 'R';
+    writeUInt32(packet + REQUEST_SIZE, now);
+
+    _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
+    _udp.write(packet, REPLY_SIZE);
+    _udp.endPacket();
+}
+
+////////////////////////////////////////////////////////////
+////////                   Slave                    ////////
+////////////////////////////////////////////////////////////
+
+uint8_t ClockSync::synchronize(const IPAddress master, const uint8_t samples)
+{
+    if (_started == false)
+    {
+        _started = _udp.begin(_port);
+        if (_started == false)
+        {
+            return false;
+        }
+    }
+
+    uint8_t valid = 0;
+    _round_trip = 0xFFFF;
+
+    for (uint8_t i = 0; i < samples; i++)
+    {
+        uint8_t packet[REPLY_SIZE] = {'G', 'P', 'S', 'Q', ++_sequence};
+        const uint32_t sent_at = millis();
+        writeUInt32(packet + 5, sent_at);
+
+        _udp.beginPacket(master, _port);
+        _udp.write(packet, REQUEST_SIZE);
+        _udp.endPacket();
+
+        while (millis() - sent_at < CLOCK_SYNC_TIMEOUT)
+        {
+            if (_udp.parsePacket() < REPLY_SIZE)
+            {
+                continue;
+            }
+            const uint32_t received_at = millis();
+            _udp.read(packet, REPLY_SIZE);
+
+            // ignore late replies to older samples
+            if (packet[3] != 'R' || packet[4] != _sequence || readUInt32(packet + 5) != sent_at)
+            {
+                continue;
+            }
+
+            const uint16_t round_trip = received_at - sent_at;
+            if (round_trip < _round_trip)
+            {
+                _round_trip = round_trip;
+                _offset = (int32_t)(readUInt32(packet + REQUEST_SIZE) - (sent_at + round_trip / 2));
+            }
+            valid++;
+            break;
+        }
+    }
+
+    return valid > 0;
+}
+
+int32_t ClockSync::offset()
+{
+    return _offset;
+}
+
+uint16_t ClockSync::roundTrip()
+{
+    return _round_trip;
+}
+
+uint32_t ClockSync::toLocal(const uint32_t master_millis)
+{
+    return master_millis - _offset;
+}
+
+uint32_t ClockSync::masterMillis()
+{
+    return millis() + _offset;
+}
+
+void ClockSync::end()
+{
+    _udp.stop();
+    _started = false;
+}
+
+////////////////////////////////////////////////////////////
+////////                  Private                  /////////
+////////////////////////////////////////////////////////////
+
+void ClockSync::writeUInt32(uint8_t buffer[], const uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        buffer[i] = value >> (8 * i);
+    }
+}
+
+uint32_t ClockSync::readUInt32(const uint8_t buffer[])
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        value |= (uint32_t)buffer[i] << (8 * i);
+    }
+    return value;
+}
@@ -0,0 +1,64 @@
+/*
+ClockSync.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <GoProControl.h>
+
+// Estimate the offset between the millis() of this board and the millis() of a master board,
+// so that GoProControl::scheduleShoot() fires at the same instant on every board.
+// The boards must be on the same network (for example all connected to the same camera access point).
+//
+// request:  'G' 'P' 'S' 'Q' seq t1          (t1: millis() of the slave when sent)
+// reply:    'G' 'P' 'S' 'R' seq t1 t2       (t2: millis() of the master when answered)
+// offset = t2 - (t1 + t3) / 2, where t3 is when the slave got the reply, the sample with
+// the shortest round trip wins because it has the smallest asymmetry error
+class ClockSync
+{
+  public:
+    ClockSync(const uint16_t port = CLOCK_SYNC_PORT);
+
+    // Master
+    uint8_t beginMaster();
+    void handle();
+
+    // Slave
+    uint8_t synchronize(const IPAddress master, const uint8_t samples = 8);
+    int32_t offset();
+    uint16_t roundTrip();
+    uint32_t toLocal(const uint32_t master_millis);
+    uint32_t masterMillis();
+
+    void end();
+
+  private:
+    WiFiUDP _udp;
+    uint16_t _port;
+    bool _started = false;
+
+    int32_t _offset = 0;
+    uint16_t _round_trip = 0xFFFF;
+    uint8_t _sequence = 0;
+
+    void writeUInt32(uint8_t buffer[], const uint32_t value);
+    uint32_t readUInt32(const uint8_t buffer[]);
+};
+
+#endif //CLOCK_SYNC_H
@@ -0,0 +1,281 @@
+/*
+CommandProtocol.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <CommandProtocol.h>
+
+// position of the fields in a command frame
+#define FRAME_SEQ 1
+#define FRAME_CAMERA 2
+#define FRAME_OPCODE 3
+#define FRAME_SETTING 4
+#define FRAME_VALUE 5
+#define FRAME_CRC 9
+
+CommandProtocol::CommandProtocol(GoProControl *cameras[], const uint8_t count)
+{
+    _cameras = cameras;
+    _count = count;
+}
+
+////////////////////////////////////////////////////////////
+////////                   Input                   /////////
+////////////////////////////////////////////////////////////
+
+void CommandProtocol::feed(const uint8_t c)
+{
+    if (_index == 0 && c != PROTOCOL_COMMAND_SYNC)
+    {
+        return; // wait the start of a frame
+    }
+
+    _frame[_index++] = c;
+    if (_index < PROTOCOL_COMMAND_SIZE)
+    {
+        return;
+    }
+    _index = 0;
+
+    if (crc8(_frame + 1, FRAME_CRC - 1) != _frame[FRAME_CRC])
+    {
+        memcpy(_error_frame, _frame, PROTOCOL_COMMAND_SIZE);
+        _error = ACK_BAD_FRAME;
+
+        // the sync byte may have been a data byte: look for another one in what we got
+        for (uint8_t i = 1; i < PROTOCOL_COMMAND_SIZE; i++)
+        {
+            if (_frame[i] == PROTOCOL_COMMAND_SYNC)
+            {
+                uint8_t rest[PROTOCOL_COMMAND_SIZE];
+                const uint8_t length = PROTOCOL_COMMAND_SIZE - i;
+                memcpy(rest, _frame + i, length);
+                for (uint8_t j = 0; j < length; j++)
+                {
+                    feed(rest[j]);
+                }
+                break;
+            }
+        }
+        return;
+    }
+
+    if (_length == PROTOCOL_QUEUE_SIZE)
+    {
+        memcpy(_error_frame, _frame, PROTOCOL_COMMAND_SIZE);
+        _error = ACK_QUEUE_FULL;
+        return;
+    }
+
+    Command &command = _queue[(_head + _length) % PROTOCOL_QUEUE_SIZE];
+    memcpy(command.frame, _frame, PROTOCOL_COMMAND_SIZE);
+    command.received_at = millis();
+    _length++;
+}
+
+void CommandProtocol::read(Stream &input)
+{
+    while (input.available() > 0)
+    {
+        feed(input.read());
+    }
+}
+
+////////////////////////////////////////////////////////////
+////////                 Execution                 /////////
+////////////////////////////////////////////////////////////
+
+bool CommandProtocol::pending()
+{
+    return _length > 0 || _error != ACK_OK;
+}
+
+uint8_t CommandProtocol::handle(Print &output)
+{
+    if (_error != ACK_OK)
+    {
+        sendAck(output, _error_frame, _error, 0, 0);
+        _error = ACK_OK;
+        return true;
+    }
+
+    if (_length == 0)
+    {
+        return false;
+    }
+
+    Command &command = _queue[_head];
+    uint32_t data = 0;
+    uint8_t result;
+
+    if (command.frame[FRAME_CAMERA] >= _count)
+    {
+        result = ACK_UNKNOWN_CAMERA;
+    }
+    else
+    {
+        result = execute(_cameras[command.frame[FRAME_CAMERA]], command.frame, data);
+    }
+
+    sendAck(output, command.frame, result, min(millis() - command.received_at, 0xFFFFUL), data);
+    _head = (_head + 1) % PROTOCOL_QUEUE_SIZE;
+    _length--;
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+////////                  Private                  /////////
+////////////////////////////////////////////////////////////
+
+uint8_t CommandProtocol::execute(GoProControl *camera, const uint8_t frame[], uint32_t &data)
+{
+    const uint32_t value = (uint32_t)frame[FRAME_VALUE] | (uint32_t)frame[FRAME_VALUE + 1] << 8 |
+                           (uint32_t)frame[FRAME_VALUE + 2] << 16 | (uint32_t)frame[FRAME_VALUE + 3] << 24;
+    uint8_t result;
+
+    switch (frame[FRAME_OPCODE])
+    {
+    case OP_PING:
+        result = true;
+        break;
+    case OP_BEGIN:
+        result = camera->begin();
+        break;
+    case OP_END:
+        camera->end();
+        result = true;
+        break;
+    case OP_TURN_ON:
+        result = camera->turnOn();
+        break;
+    case OP_TURN_OFF:
+        result = camera->turnOff();
+        break;
+    case OP_SHOOT:
+        result = camera->shoot();
+        break;
+    case OP_STOP_SHOOT:
+        result = camera->stopShoot();
+        break;
+    case OP_LOCALIZATION:
+        result = value ? camera->localizationOn() : camera->localizationOff();
+        break;
+    case OP_DELETE_LAST:
+        result = camera->deleteLast();
+        break;
+    case OP_DELETE_ALL:
+        result = camera->deleteAll();
+        break;
+#if defined(GOPRO_SCHEDULE)
+    case OP_SCHEDULE_SHOOT:
+        result = camera->scheduleShoot(value);
+        break;
+#endif
+    case OP_SYNC_CLOCK:
+        result = camera->syncClock(value);
+        break;
+    case OP_STATE:
+        data = camera->getState();
+        return ACK_OK;
+    case OP_IS_ON:
+        result = camera->isOn();
+        break;
+
+    case OP_SET:
+        switch (frame[FRAME_SETTING])
+        {
+        case SET_MODE:
+            result = camera->setMode(value);
+            break;
+        case SET_ORIENTATION:
+            result = camera->setOrientation(value);
+            break;
+        case SET_VIDEO_RESOLUTION:
+            result = camera->setVideoResolution(value);
+            break;
+        case SET_VIDEO_FOV:
+            result = camera->setVideoFov(value);
+            break;
+        case SET_FRAME_RATE:
+            result = camera->setFrameRate(value);
+            break;
+        case SET_VIDEO_ENCODING:
+            result = camera->setVideoEncoding(value);
+            break;
+        case SET_PHOTO_RESOLUTION:
+            result = camera->setPhotoResolution(value);
+            break;
+        case SET_TIME_LAPSE_INTERVAL:
+            result = camera->setTimeLapseInterval(value / 10.0);
+            break;
+        case SET_CONTINUOUS_SHOT:
+            result = camera->setContinuousShot(value);
+            break;
+        default:
+            return ACK_UNKNOWN_OPCODE;
+        }
+        break;
+
+    default:
+        return ACK_UNKNOWN_OPCODE;
+    }
+
+    data = camera->lastRoundTrip();
+
+    if (result == true)
+    {
+        return ACK_OK;
+    }
+    else if (result == false)
+    {
+        return ACK_FAILED;
+    }
+    return ACK_REJECTED;
+}
+
+void CommandProtocol::sendAck(Print &output, const uint8_t frame[], const uint8_t result, const uint16_t latency, const uint32_t data)
+{
+    uint8_t ack[PROTOCOL_ACK_SIZE] = {
+        PROTOCOL_ACK_SYNC,
+        frame[FRAME_SEQ],
+        frame[FRAME_CAMERA],
+        frame[FRAME_OPCODE],
+        result,
+        (uint8_t)latency,
+        (uint8_t)(latency >> 8),
+        (uint8_t)data,
+        (uint8_t)(data >> 8),
+        (uint8_t)(data >> 16),
+        (uint8_t)(data >> 24),
+    };
+    ack[PROTOCOL_ACK_SIZE - 1] = crc8(ack + 1, PROTOCOL_ACK_SIZE - 2);
+    output.write(ack, PROTOCOL_ACK_SIZE);
+}
+
+uint8_t CommandProtocol::crc8(const uint8_t data[], const uint8_t length)
+{
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
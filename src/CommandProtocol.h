@@ -0,0 +1,109 @@
+/*
+CommandProtocol.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef COMMAND_PROTOCOL_H
+#define COMMAND_PROTOCOL_H
+
+#include <GoProControl.h>
+
+#define PROTOCOL_QUEUE_SIZE 8
+#define PROTOCOL_COMMAND_SYNC 0xA5
+#define PROTOCOL_ACK_SYNC 0x5A
+#define PROTOCOL_COMMAND_SIZE 10
+#define PROTOCOL_ACK_SIZE 12
+
+// Binary protocol to drive one or more GoProControl from a ground station over Serial, UDP or TCP
+//
+// command: sync(0xA5) seq camera opcode setting value[4] crc
+// ack:     sync(0x5A) seq camera opcode result latency[2] data[4] crc
+//
+// multi byte fields are little endian, crc is CRC-8 (polynomial 0x07, init 0x00) of every byte
+// between the sync and the crc. Commands can be sent back to back, they are queued and each one
+// gets its own ack, matched by seq, carrying the ms elapsed from its reception to its completion
+enum protocol_opcode
+{
+    OP_PING = 0,
+    OP_BEGIN,
+    OP_END,
+    OP_TURN_ON,
+    OP_TURN_OFF,
+    OP_SHOOT,
+    OP_STOP_SHOOT,
+    OP_SET,            // setting: setting_type, value: the option (SET_TIME_LAPSE_INTERVAL in tenths of second)
+    OP_LOCALIZATION,   // value: 1 on, 0 off
+    OP_DELETE_LAST,
+    OP_DELETE_ALL,
+    OP_SCHEDULE_SHOOT, // value: millis() of the board
+    OP_SYNC_CLOCK,     // value: unix time
+    OP_STATE,          // data: connection_state
+    OP_IS_ON,
+    protocol_opcode_last
+};
+
+enum protocol_result
+{
+    ACK_OK = 0,
+    ACK_FAILED,         // the command returned false
+    ACK_REJECTED,       // the command returned -1: wrong option for this camera
+    ACK_BAD_FRAME,      // wrong crc, the seq may be wrong too
+    ACK_UNKNOWN_OPCODE,
+    ACK_UNKNOWN_CAMERA,
+    ACK_QUEUE_FULL
+};
+
+class CommandProtocol
+{
+  public:
+    CommandProtocol(GoProControl *cameras[], const uint8_t count);
+
+    // Input
+    void feed(const uint8_t c);
+    void read(Stream &input);
+
+    // Execution
+    bool pending();
+    uint8_t handle(Print &output);
+
+  private:
+    struct Command
+    {
+        uint8_t frame[PROTOCOL_COMMAND_SIZE];
+        uint32_t received_at;
+    };
+
+    GoProControl **_cameras;
+    uint8_t _count;
+
+    uint8_t _frame[PROTOCOL_COMMAND_SIZE];
+    uint8_t _index = 0;
+
+    Command _queue[PROTOCOL_QUEUE_SIZE];
+    uint8_t _head = 0;
+    uint8_t _length = 0;
+
+    // errors found while reading, reported at the next handle()
+    uint8_t _error_frame[PROTOCOL_COMMAND_SIZE];
+    uint8_t _error = ACK_OK;
+
+    uint8_t execute(GoProControl *camera, const uint8_t frame[], uint32_t &data);
+    void sendAck(Print &output, const uint8_t frame[], const uint8_t result, const uint16_t latency, const uint32_t data);
+    uint8_t crc8(const uint8_t data[], const uint8_t length);
+};
+
+#endif //COMMAND_PROTOCOL_H
@@ -0,0 +1,521 @@
+/*
+Dialects.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <GoProControl.h>
+#define LEN(x) ((sizeof(x) / sizeof(0 [x])) / ((size_t)(!(sizeof(x) % sizeof(0 [x])))))
+
+////////////////////////////////////////////////////////////
+////////                  Helpers                  /////////
+////////////////////////////////////////////////////////////
+
+// append a string from flash, return the new length or size if it doesn't fit
+static uint16_t appendP(char buffer[], const uint16_t size, uint16_t length, PGM_P text)
+{
+    char c;
+    while (length < size && (c = pgm_read_byte(text++)) != '\0')
+    {
+        buffer[length++] = c;
+    }
+    return length;
+}
+
+static uint16_t append(char buffer[], const uint16_t size, uint16_t length, const char *text)
+{
+    while (length < size && *text != '\0')
+    {
+        buffer[length++] = *text++;
+    }
+    return length;
+}
+
+static uint16_t terminate(char buffer[], const uint16_t size, const uint16_t length)
+{
+    if (length >= size)
+    {
+        return 0;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+// value of an option, or -1 if the option isn't in the table
+static int16_t findOption(const SettingTable *table, const uint8_t option)
+{
+    const OptionValue *options = (const OptionValue *)pgm_read_ptr(&table->options);
+    const uint8_t count = pgm_read_byte(&table->count);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (pgm_read_byte(&options[i].option) == option)
+        {
+            return pgm_read_byte(&options[i].value);
+        }
+    }
+    return -1;
+}
+
+// copy the options of a table, return how many
+static uint8_t copyOptions(const SettingTable *table, uint8_t options[], const uint8_t size)
+{
+    const OptionValue *values = (const OptionValue *)pgm_read_ptr(&table->options);
+    const uint8_t count = pgm_read_byte(&table->count);
+    uint8_t i = 0;
+    for (; i < count && i < size; i++)
+    {
+        options[i] = pgm_read_byte(&values[i].option);
+    }
+    return i;
+}
+
+////////////////////////////////////////////////////////////
+////////                   HERO3                   /////////
+////////////////////////////////////////////////////////////
+
+static const OptionValue HERO3_MODE[] PROGMEM = {
+    {VIDEO_MODE, 0x00},
+    {PHOTO_MODE, 0x01},
+    {BURST_MODE, 0x02},
+    {TIMELAPSE_MODE, 0x03},
+    {TIMER_MODE, 0x04},
+    {PLAY_HDMI_MODE, 0x05},
+};
+
+static const OptionValue HERO3_ORIENTATION[] PROGMEM = {
+    {ORIENTATION_UP, 0x00},
+    {ORIENTATION_DOWN, 0x01},
+};
+
+static const OptionValue HERO3_VIDEO_RESOLUTION[] PROGMEM = {
+    {VR_1080p, 0x06},
+    {VR_960p, 0x05},
+    {VR_720p, 0x03},
+    {VR_WVGA, 0x01},
+};
+
+static const OptionValue HERO3_VIDEO_FOV[] PROGMEM = {
+    {WIDE_FOV, 0x00},
+    {MEDIUM_FOV, 0x01},
+    {NARROW_FOV, 0x02},
+};
+
+static const OptionValue HERO3_FRAME_RATE[] PROGMEM = {
+    {FR_240, 0x0a},
+    {FR_120, 0x09},
+    {FR_100, 0x08},
+    {FR_60, 0x07},
+    {FR_50, 0x06},
+    {FR_48, 0x05},
+    {FR_30, 0x04},
+    {FR_25, 0x03},
+    {FR_24, 0x02},
+    {FR_12p5, 0x0b},
+    {FR_15, 0x01},
+    {FR_12, 0x00},
+};
+
+static const OptionValue HERO3_VIDEO_ENCODING[] PROGMEM = {
+    {NTSC, 0x00},
+    {PAL, 0x01},
+};
+
+static const OptionValue HERO3_PHOTO_RESOLUTION[] PROGMEM = {
+    {PR_11MP_WIDE, 0x00},
+    {PR_8MP_WIDE, 0x01},
+    {PR_5MP_WIDE, 0x02},
+};
+
+// seconds, 0 is 0.5
+static const OptionValue HERO3_TIME_LAPSE_INTERVAL[] PROGMEM = {
+    {60, 0x3c},
+    {30, 0x1e},
+    {10, 0x0a},
+    {5, 0x05},
+    {1, 0x01},
+    {0, 0x00},
+};
+
+static const OptionValue HERO3_CONTINUOUS_SHOT[] PROGMEM = {
+    {10, 0x0a},
+    {5, 0x05},
+    {3, 0x03},
+    {0, 0x00},
+};
+
+static const char HERO3_CM[] PROGMEM = "/camera/CM";
+static const char HERO3_UP[] PROGMEM = "/camera/UP";
+static const char HERO3_VR[] PROGMEM = "/camera/VR";
+static const char HERO3_FV[] PROGMEM = "/camera/FV";
+static const char HERO3_FS[] PROGMEM = "/camera/FS";
+static const char HERO3_VM[] PROGMEM = "/camera/VM";
+static const char HERO3_PR[] PROGMEM = "/camera/PR";
+static const char HERO3_TI[] PROGMEM = "/camera/TI";
+static const char HERO3_CS[] PROGMEM = "/camera/CS";
+
+// same order of setting_type
+static const SettingTable HERO3_SETTINGS[setting_type_last] PROGMEM = {
+    {HERO3_CM, HERO3_MODE, LEN(HERO3_MODE)},
+    {HERO3_UP, HERO3_ORIENTATION, LEN(HERO3_ORIENTATION)},
+    {HERO3_VR, HERO3_VIDEO_RESOLUTION, LEN(HERO3_VIDEO_RESOLUTION)},
+    {HERO3_FV, HERO3_VIDEO_FOV, LEN(HERO3_VIDEO_FOV)},
+    {HERO3_FS, HERO3_FRAME_RATE, LEN(HERO3_FRAME_RATE)},
+    {HERO3_VM, HERO3_VIDEO_ENCODING, LEN(HERO3_VIDEO_ENCODING)},
+    {HERO3_PR, HERO3_PHOTO_RESOLUTION, LEN(HERO3_PHOTO_RESOLUTION)},
+    {HERO3_TI, HERO3_TIME_LAPSE_INTERVAL, LEN(HERO3_TIME_LAPSE_INTERVAL)},
+    {HERO3_CS, HERO3_CONTINUOUS_SHOT, LEN(HERO3_CONTINUOUS_SHOT)},
+};
+
+// the "?t=<password>" fragment goes in place of the '?': "/bacpac/PW?&p=%01" is sent as "/bacpac/PW?t=<password>&p=%01"
+static const char HERO3_POWER_ON[] PROGMEM = "/bacpac/PW?&p=%01";
+static const char HERO3_POWER_OFF[] PROGMEM = "/bacpac/PW?&p=%00";
+static const char HERO3_SHUTTER_ON[] PROGMEM = "/bacpac/SH?&p=%01";
+static const char HERO3_SHUTTER_OFF[] PROGMEM = "/bacpac/SH?&p=%00";
+static const char HERO3_LOCATE_ON[] PROGMEM = "/camera/LL?&p=%01";
+static const char HERO3_LOCATE_OFF[] PROGMEM = "/camera/LL?&p=%00";
+static const char HERO3_DELETE_LAST[] PROGMEM = "/camera/DL?";
+static const char HERO3_DELETE_ALL[] PROGMEM = "/camera/DA?";
+static const char HERO3_STATUS[] PROGMEM = "/camera/se?";
+// no JSON info and no HiLight tag on this camera
+
+// same order of command_type
+static const char *const HERO3_COMMANDS[command_type_last] PROGMEM = {
+    HERO3_POWER_ON,
+    HERO3_POWER_OFF,
+    HERO3_SHUTTER_ON,
+    HERO3_SHUTTER_OFF,
+    HERO3_LOCATE_ON,
+    HERO3_LOCATE_OFF,
+    HERO3_DELETE_LAST,
+    HERO3_DELETE_ALL,
+    HERO3_STATUS,
+    NULL,
+    NULL,
+};
+
+static const char HEX_DIGITS[] PROGMEM = "0123456789abcdef";
+
+const bool Hero3Dialect::keep_alive;
+const bool Hero3Dialect::host_with_port;
+
+bool Hero3Dialect::supports(const uint8_t setting)
+{
+    return setting < setting_type_last && pgm_read_byte(&HERO3_SETTINGS[setting].count) > 0;
+}
+
+bool Hero3Dialect::hasOption(const uint8_t setting, const uint8_t option)
+{
+    return supports(setting) && findOption(&HERO3_SETTINGS[setting], option) >= 0;
+}
+
+uint8_t Hero3Dialect::listOptions(const uint8_t setting, uint8_t options[], const uint8_t size)
+{
+    if (!supports(setting))
+    {
+        return 0;
+    }
+    return copyOptions(&HERO3_SETTINGS[setting], options, size);
+}
+
+uint8_t Hero3Dialect::buildAuth(char buffer[], const uint8_t size, const char *password)
+{
+    const uint16_t length = append(buffer, size, append(buffer, size, 0, "?t="), password);
+    return terminate(buffer, size, length);
+}
+
+uint16_t Hero3Dialect::buildSetting(char buffer[], const uint16_t size, const uint8_t setting, const uint8_t option, const char *auth, const uint8_t auth_length)
+{
+    if (!supports(setting))
+    {
+        return 0;
+    }
+
+    const int16_t value = findOption(&HERO3_SETTINGS[setting], option);
+    if (value < 0)
+    {
+        return 0;
+    }
+
+    // <path><auth>&p=%<two hex digits>
+    PGM_P path = (PGM_P)pgm_read_ptr(&HERO3_SETTINGS[setting].path);
+    const uint16_t path_length = strlen_P(path);
+    uint16_t length = path_length + auth_length + 6;
+    if (length >= size)
+    {
+        return 0;
+    }
+
+    memcpy_P(buffer, path, path_length);
+    memcpy(buffer + path_length, auth, auth_length);
+    char *parameter = buffer + path_length + auth_length;
+    memcpy(parameter, "&p=%", 4);
+    parameter[4] = pgm_read_byte(&HEX_DIGITS[value >> 4]);
+    parameter[5] = pgm_read_byte(&HEX_DIGITS[value & 0x0F]);
+    buffer[length] = '\0';
+    return length;
+}
+
+uint16_t Hero3Dialect::buildCommand(char buffer[], const uint16_t size, const uint8_t command, const char *auth, const uint8_t auth_length)
+{
+    if (command >= command_type_last)
+    {
+        return 0;
+    }
+
+    PGM_P path = (PGM_P)pgm_read_ptr(&HERO3_COMMANDS[command]);
+    if (path == NULL)
+    {
+        return 0;
+    }
+
+    uint16_t length = 0;
+    char c;
+    while (length < size && (c = pgm_read_byte(path++)) != '\0')
+    {
+        if (c == '?')
+        {
+            if (length + auth_length >= size)
+            {
+                return 0;
+            }
+            memcpy(buffer + length, auth, auth_length);
+            length += auth_length;
+        }
+        else
+        {
+            buffer[length++] = c;
+        }
+    }
+    return terminate(buffer, size, length);
+}
+
+////////////////////////////////////////////////////////////
+////////                 gpControl                 /////////
+////////////////////////////////////////////////////////////
+
+// mode in the high nibble, sub mode in the low one, 0xF for none
+#define NO_SUB_MODE 0x0F
+static const OptionValue GPCONTROL_MODE[] PROGMEM = {
+    {VIDEO_MODE, 0x0F},
+    {VIDEO_SUB_MODE, 0x00},
+    {VIDEO_TIMELAPSE_MODE, 0x01},
+    {VIDEO_PHOTO_MODE, 0x02},    // not supported by HERO6 and above
+    {VIDEO_LOOPING_MODE, 0x03},  // HERO7_BLACK and presumably above
+    {VIDEO_TIMEWARP_MODE, 0x04}, // HERO7_BLACK and presumably above
+    {PHOTO_MODE, 0x1F},
+    {PHOTO_SINGLE_MODE, 0x11},
+    {PHOTO_NIGHT_MODE, 0x12}, // HERO7_BLACK and presumably above
+    {MULTISHOT_MODE, 0x2F},
+    {MULTISHOT_BURST_MODE, 0x20},
+    {MULTISHOT_TIMELAPSE_MODE, 0x21},  // HERO7_BLACK and presumably above
+    {MULTISHOT_NIGHTLAPSE_MODE, 0x22}, // HERO7_BLACK and presumably above
+};
+
+static const OptionValue GPCONTROL_ORIENTATION[] PROGMEM = {
+    {ORIENTATION_UP, 0},
+    {ORIENTATION_DOWN, 1},
+    {ORIENTATION_AUTO, 2},
+};
+
+static const OptionValue GPCONTROL_VIDEO_RESOLUTION[] PROGMEM = {
+    {VR_4K, 1},
+    {VR_2K, 4},
+    {VR_2K_SuperView, 5},
+    {VR_1440p, 7},
+    {VR_1080p_SuperView, 8},
+    {VR_1080p, 9},
+    {VR_960p, 10},
+    {VR_720p_SuperView, 11},
+    {VR_720p, 12},
+    {VR_WVGA, 13},
+};
+
+static const OptionValue GPCONTROL_VIDEO_FOV[] PROGMEM = {
+    {WIDE_FOV, 0},
+    {MEDIUM_FOV, 1},
+    {NARROW_FOV, 2},
+    {LINEAR_FOV, 4},
+};
+
+static const OptionValue GPCONTROL_FRAME_RATE[] PROGMEM = {
+    {FR_240, 0},
+    {FR_120, 1},
+    {FR_100, 2},
+    {FR_90, 3},
+    {FR_80, 4},
+    {FR_60, 5},
+    {FR_50, 6},
+    {FR_48, 7},
+    {FR_30, 8},
+    {FR_25, 9},
+};
+
+static const OptionValue GPCONTROL_VIDEO_ENCODING[] PROGMEM = {
+    {NTSC, 0},
+    {PAL, 1},
+};
+
+static const OptionValue GPCONTROL_PHOTO_RESOLUTION[] PROGMEM = {
+    {PR_12MP_WIDE, 0},
+    {PR_12MP_LINEAR, 10},
+    {PR_12MP_MEDIUM, 8},
+    {PR_12MP_NARROW, 9},
+    {PR_7MP_WIDE, 1},
+    {PR_7MP_MEDIUM, 2},
+    {PR_5MP_WIDE, 3},
+};
+
+// seconds, 0 is 0.5
+static const OptionValue GPCONTROL_TIME_LAPSE_INTERVAL[] PROGMEM = {
+    {60, 6},
+    {30, 5},
+    {10, 4},
+    {5, 3},
+    {1, 1},
+    {0, 0},
+};
+
+static const char GPCONTROL_ORIENTATION_ID[] PROGMEM = "52";
+static const char GPCONTROL_VIDEO_RESOLUTION_ID[] PROGMEM = "2";
+static const char GPCONTROL_VIDEO_FOV_ID[] PROGMEM = "4";
+static const char GPCONTROL_FRAME_RATE_ID[] PROGMEM = "3";
+static const char GPCONTROL_VIDEO_ENCODING_ID[] PROGMEM = "57";
+static const char GPCONTROL_PHOTO_RESOLUTION_ID[] PROGMEM = "17";
+static const char GPCONTROL_TIME_LAPSE_INTERVAL_ID[] PROGMEM = "5";
+
+// same order of setting_type, the mode has its own commands and continuous shot doesn't exist
+static const SettingTable GPCONTROL_SETTINGS[setting_type_last] PROGMEM = {
+    {NULL, GPCONTROL_MODE, LEN(GPCONTROL_MODE)},
+    {GPCONTROL_ORIENTATION_ID, GPCONTROL_ORIENTATION, LEN(GPCONTROL_ORIENTATION)},
+    {GPCONTROL_VIDEO_RESOLUTION_ID, GPCONTROL_VIDEO_RESOLUTION, LEN(GPCONTROL_VIDEO_RESOLUTION)},
+    {GPCONTROL_VIDEO_FOV_ID, GPCONTROL_VIDEO_FOV, LEN(GPCONTROL_VIDEO_FOV)},
+    {GPCONTROL_FRAME_RATE_ID, GPCONTROL_FRAME_RATE, LEN(GPCONTROL_FRAME_RATE)},
+    {GPCONTROL_VIDEO_ENCODING_ID, GPCONTROL_VIDEO_ENCODING, LEN(GPCONTROL_VIDEO_ENCODING)},
+    {GPCONTROL_PHOTO_RESOLUTION_ID, GPCONTROL_PHOTO_RESOLUTION, LEN(GPCONTROL_PHOTO_RESOLUTION)},
+    {GPCONTROL_TIME_LAPSE_INTERVAL_ID, GPCONTROL_TIME_LAPSE_INTERVAL, LEN(GPCONTROL_TIME_LAPSE_INTERVAL)},
+    {NULL, NULL, 0},
+};
+
+static const char GPCONTROL_POWER_OFF[] PROGMEM = "/gp/gpControl/command/system/sleep";
+static const char GPCONTROL_SHUTTER_ON[] PROGMEM = "/gp/gpControl/command/shutter?p=1";
+static const char GPCONTROL_SHUTTER_OFF[] PROGMEM = "/gp/gpControl/command/shutter?p=0";
+static const char GPCONTROL_LOCATE_ON[] PROGMEM = "/gp/gpControl/command/system/locate?p=1";
+static const char GPCONTROL_LOCATE_OFF[] PROGMEM = "/gp/gpControl/command/system/locate?p=0";
+static const char GPCONTROL_DELETE_LAST[] PROGMEM = "/gp/gpControl/command/storage/delete/last";
+static const char GPCONTROL_DELETE_ALL[] PROGMEM = "/gp/gpControl/command/storage/delete/all";
+static const char GPCONTROL_STATUS[] PROGMEM = "/gp/gpControl/status";
+static const char GPCONTROL_INFO[] PROGMEM = "/gp/gpControl/info";
+static const char GPCONTROL_TAG_MOMENT[] PROGMEM = "/gp/gpControl/command/storage/tag_moment";
+
+// same order of command_type, the power on is a wake on lan packet
+static const char *const GPCONTROL_COMMANDS[command_type_last] PROGMEM = {
+    NULL,
+    GPCONTROL_POWER_OFF,
+    GPCONTROL_SHUTTER_ON,
+    GPCONTROL_SHUTTER_OFF,
+    GPCONTROL_LOCATE_ON,
+    GPCONTROL_LOCATE_OFF,
+    GPCONTROL_DELETE_LAST,
+    GPCONTROL_DELETE_ALL,
+    GPCONTROL_STATUS,
+    GPCONTROL_INFO,
+    GPCONTROL_TAG_MOMENT,
+};
+
+static const char GPCONTROL_SETTING[] PROGMEM = "/gp/gpControl/setting/";
+static const char GPCONTROL_MODE_COMMAND[] PROGMEM = "/gp/gpControl/command/mode?p=";
+static const char GPCONTROL_SUB_MODE_COMMAND[] PROGMEM = "/gp/gpControl/command/sub_mode?mode=";
+static const char GPCONTROL_SUB_MODE_PARAMETER[] PROGMEM = "&sub_mode=";
+
+const bool GpControlDialect::keep_alive;
+const bool GpControlDialect::host_with_port;
+
+bool GpControlDialect::supports(const uint8_t setting)
+{
+    return setting < setting_type_last && pgm_read_byte(&GPCONTROL_SETTINGS[setting].count) > 0;
+}
+
+bool GpControlDialect::hasOption(const uint8_t setting, const uint8_t option)
+{
+    return supports(setting) && findOption(&GPCONTROL_SETTINGS[setting], option) >= 0;
+}
+
+uint8_t GpControlDialect::listOptions(const uint8_t setting, uint8_t options[], const uint8_t size)
+{
+    if (!supports(setting))
+    {
+        return 0;
+    }
+    return copyOptions(&GPCONTROL_SETTINGS[setting], options, size);
+}
+
+uint16_t GpControlDialect::buildSetting(char buffer[], const uint16_t size, const uint8_t setting, const uint8_t option, const char *auth, const uint8_t auth_length)
+{
+    if (!supports(setting))
+    {
+        return 0;
+    }
+
+    const int16_t value = findOption(&GPCONTROL_SETTINGS[setting], option);
+    if (value < 0)
+    {
+        return 0;
+    }
+
+    char number[4];
+    uint16_t length;
+
+    if (setting == SET_MODE)
+    {
+        utoa(value >> 4, number, 10);
+        if ((value & 0x0F) == NO_SUB_MODE)
+        {
+            length = appendP(buffer, size, 0, GPCONTROL_MODE_COMMAND);
+            length = append(buffer, size, length, number);
+        }
+        else
+        {
+            length = appendP(buffer, size, 0, GPCONTROL_SUB_MODE_COMMAND);
+            length = append(buffer, size, length, number);
+            length = appendP(buffer, size, length, GPCONTROL_SUB_MODE_PARAMETER);
+            utoa(value & 0x0F, number, 10);
+            length = append(buffer, size, length, number);
+        }
+        return terminate(buffer, size, length);
+    }
+
+    length = appendP(buffer, size, 0, GPCONTROL_SETTING);
+    length = appendP(buffer, size, length, (PGM_P)pgm_read_ptr(&GPCONTROL_SETTINGS[setting].path));
+    length = append(buffer, size, length, "/");
+    utoa(value, number, 10);
+    length = append(buffer, size, length, number);
+    return terminate(buffer, size, length);
+}
+
+uint16_t GpControlDialect::buildCommand(char buffer[], const uint16_t size, const uint8_t command, const char *auth, const uint8_t auth_length)
+{
+    if (command >= command_type_last)
+    {
+        return 0;
+    }
+
+    PGM_P path = (PGM_P)pgm_read_ptr(&GPCONTROL_COMMANDS[command]);
+    if (path == NULL)
+    {
+        return 0;
+    }
+    return terminate(buffer, size, appendP(buffer, size, 0, path));
+}
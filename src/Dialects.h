@@ -0,0 +1,102 @@
+/*
+Dialects.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DIALECTS_H
+#define DIALECTS_H
+
+#include <Arduino.h>
+
+// commands without options, the path of each one is in the table of every dialect
+enum command_type
+{
+    CMD_POWER_ON = 0,
+    CMD_POWER_OFF,
+    CMD_SHUTTER_ON,
+    CMD_SHUTTER_OFF,
+    CMD_LOCATE_ON,
+    CMD_LOCATE_OFF,
+    CMD_DELETE_LAST,
+    CMD_DELETE_ALL,
+    CMD_STATUS,
+    CMD_INFO,
+    CMD_TAG_MOMENT,
+    command_type_last
+};
+
+// an option from Settings.h and the value the camera wants for it
+struct OptionValue
+{
+    uint8_t option;
+    uint8_t value;
+};
+
+struct SettingTable
+{
+    const char *path;
+    const OptionValue *options;
+    uint8_t count;
+};
+
+// The request format of a camera family: every table is in flash and the builders write the
+// path of the request in a buffer, they return its length or 0 if the option is wrong or the
+// buffer too small. The two dialects have the same interface, GoProControl picks one for
+// each request or, with GOPRO_HERO3_ONLY/GOPRO_GPCONTROL_ONLY, once at compile time so the
+// other one is not linked at all
+
+// HERO3: <path>?t=<password>&p=%<value as two hex digits>
+// the "?t=<password>" fragment (auth) is built once by buildAuth(), then a request is a few memcpy
+struct Hero3Dialect
+{
+    static const bool keep_alive = false;    // the camera never closes the connection
+    static const bool host_with_port = true; // "Host: 10.5.5.9:80"
+
+    static uint8_t buildAuth(char buffer[], const uint8_t size, const char *password);
+    static bool supports(const uint8_t setting);
+    static bool hasOption(const uint8_t setting, const uint8_t option);
+    static uint8_t listOptions(const uint8_t setting, uint8_t options[], const uint8_t size);
+    static uint16_t buildSetting(char buffer[], const uint16_t size, const uint8_t setting, const uint8_t option, const char *auth, const uint8_t auth_length);
+    static uint16_t buildCommand(char buffer[], const uint16_t size, const uint8_t command, const char *auth, const uint8_t auth_length);
+};
+
+// HERO4 and newer: /gp/gpControl/setting/<path>/<value in decimal>, no password so auth is ignored
+struct GpControlDialect
+{
+    static const bool keep_alive = true;
+    static const bool host_with_port = false;
+
+    static bool supports(const uint8_t setting);
+    static bool hasOption(const uint8_t setting, const uint8_t option);
+    static uint8_t listOptions(const uint8_t setting, uint8_t options[], const uint8_t size);
+    static uint16_t buildSetting(char buffer[], const uint16_t size, const uint8_t setting, const uint8_t option, const char *auth, const uint8_t auth_length);
+    static uint16_t buildCommand(char buffer[], const uint16_t size, const uint8_t command, const char *auth, const uint8_t auth_length);
+};
+
+// the dialect of the camera inside a member of a class with a _camera field (GoProControl,
+// Capabilities): a constant when the build is limited to a family (see Settings.h), then the
+// compiler drops the branches and the tables of the other one
+#if defined(GOPRO_HERO3_ONLY)
+#define HERO3_DIALECT true
+#elif defined(GOPRO_GPCONTROL_ONLY)
+#define HERO3_DIALECT false
+#else
+#define HERO3_DIALECT (_camera == HERO3)
+#endif
+#define DIALECT(member) (HERO3_DIALECT ? Hero3Dialect::member : GpControlDialect::member)
+
+#endif //DIALECTS_H
@@ -0,0 +1,197 @@
+/*
+Esp32BleLink.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <GoProControl.h>
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_BLE)
+
+static const char GOPRO_SERVICE[] = "0000fea6-0000-1000-8000-00805f9b34fb";
+static const char COMMAND_CHARACTERISTIC[] = "b5f90072-aa8d-11e3-9046-0002a5d5c51b";
+static const char RESPONSE_CHARACTERISTIC[] = "b5f90073-aa8d-11e3-9046-0002a5d5c51b";
+
+Esp32BleLink *Esp32BleLink::_links[ESP32_BLE_LINKS] = {};
+
+Esp32BleLink::Esp32BleLink(const char *camera)
+{
+    select(camera);
+    for (uint8_t i = 0; i < ESP32_BLE_LINKS; i++)
+    {
+        if (_links[i] == NULL)
+        {
+            _links[i] = this;
+            break;
+        }
+    }
+}
+
+Esp32BleLink::~Esp32BleLink()
+{
+    disconnect();
+    for (uint8_t i = 0; i < ESP32_BLE_LINKS; i++)
+    {
+        if (_links[i] == this)
+        {
+            _links[i] = NULL;
+        }
+    }
+}
+
+void Esp32BleLink::select(const char *camera)
+{
+    if (camera == NULL)
+    {
+        _camera[0] = '\0';
+        return;
+    }
+    strncpy(_camera, camera, sizeof(_camera) - 1);
+    _camera[sizeof(_camera) - 1] = '\0';
+}
+
+bool Esp32BleLink::connect(const uint32_t timeout)
+{
+    if (connected())
+    {
+        return true;
+    }
+
+    // a link that didn't fit in the table wouldn't get its notifications
+    bool registered = false;
+    for (uint8_t i = 0; i < ESP32_BLE_LINKS; i++)
+    {
+        registered = registered || _links[i] == this;
+    }
+    if (!registered)
+    {
+        return false;
+    }
+
+    const uint32_t start_time = millis();
+    BLEDevice::init("");
+    BLEDevice::setEncryptionLevel(ESP_BLE_SEC_ENCRYPT);
+    BLESecurity security;
+    security.setAuthenticationMode(ESP_LE_AUTH_REQ_SC_BOND);
+    security.setCapability(ESP_IO_CAP_NONE);
+
+    BLEScan *scan = BLEDevice::getScan();
+    scan->setActiveScan(true);
+    BLEScanResults results = scan->start(min((uint32_t)BLE_SCAN_TIME, timeout / 1000 + 1), false);
+
+    BLEAdvertisedDevice camera;
+    bool found = false;
+    for (int i = 0; i < results.getCount() && !found; i++)
+    {
+        camera = results.getDevice(i);
+        found = matches(camera);
+    }
+    scan->clearResults();
+
+    if (!found || millis() - start_time >= timeout)
+    {
+        return false;
+    }
+
+    if (_client == NULL)
+    {
+        _client = BLEDevice::createClient();
+    }
+    if (!_client->connect(&camera))
+    {
+        return false;
+    }
+
+    BLERemoteService *service = _client->getService(BLEUUID(GOPRO_SERVICE));
+    if (service != NULL)
+    {
+        _command = service->getCharacteristic(BLEUUID(COMMAND_CHARACTERISTIC));
+        _response = service->getCharacteristic(BLEUUID(RESPONSE_CHARACTERISTIC));
+    }
+    if (_command == NULL || _response == NULL || !_response->canNotify())
+    {
+        disconnect();
+        return false;
+    }
+    _response->registerForNotify(onNotify);
+    return true;
+}
+
+bool Esp32BleLink::connected()
+{
+    return _client != NULL && _command != NULL && _client->isConnected();
+}
+
+void Esp32BleLink::disconnect()
+{
+    if (_client != NULL && _client->isConnected())
+    {
+        _client->disconnect();
+    }
+    _command = NULL;
+    _response = NULL;
+}
+
+bool Esp32BleLink::writeCommand(const uint8_t *data, const size_t size)
+{
+    if (!connected())
+    {
+        return false;
+    }
+    _command->writeValue((uint8_t *)data, size, true);
+    return true;
+}
+
+// the GoPro service, the camera asked for and not already taken by another link
+bool Esp32BleLink::matches(BLEAdvertisedDevice &device)
+{
+    if (!device.haveServiceUUID() || !device.isAdvertisingService(BLEUUID(GOPRO_SERVICE)))
+    {
+        return false;
+    }
+    if (_camera[0] != '\0')
+    {
+        return strcmp(device.getName().c_str(), _camera) == 0 ||
+               strcasecmp(device.getAddress().toString().c_str(), _camera) == 0;
+    }
+
+    for (uint8_t i = 0; i < ESP32_BLE_LINKS; i++)
+    {
+        if (_links[i] != NULL && _links[i] != this && _links[i]->connected() &&
+            _links[i]->_client->getPeerAddress().equals(device.getAddress()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// runs in the Bluetooth task
+void Esp32BleLink::onNotify(BLERemoteCharacteristic *characteristic, uint8_t *data, size_t size, bool is_notify)
+{
+    for (uint8_t i = 0; i < ESP32_BLE_LINKS; i++)
+    {
+        Esp32BleLink *link = _links[i];
+        if (link != NULL && link->_response == characteristic)
+        {
+            link->response(data, size);
+            return;
+        }
+    }
+}
+
+#endif
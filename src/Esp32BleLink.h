@@ -0,0 +1,61 @@
+/*
+Esp32BleLink.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ESP32_BLE_LINK_H
+#define ESP32_BLE_LINK_H
+
+#include <BleLink.h>
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_BLE)
+
+#include <Arduino.h>
+#include <BLEDevice.h>
+
+// BleLink on the BLE library of the ESP32 core: scans for a camera advertising the GoPro
+// service, bonds with it (the camera must be in pairing mode the first time) and subscribes
+// the responses. With several cameras give each link the name ("GoPro 1234") or the address
+// of its own, without one it takes the first camera no other link is connected to. Up to
+// ESP32_BLE_LINKS links at once: the notify callback of the library has no argument, the
+// links are found from the characteristic in a static table
+class Esp32BleLink : public BleLink
+{
+  public:
+    Esp32BleLink(const char *camera = NULL);
+    ~Esp32BleLink();
+
+    void select(const char *camera); // name or address, NULL for any camera
+    bool connect(const uint32_t timeout);
+    bool connected();
+    void disconnect();
+    bool writeCommand(const uint8_t *data, const size_t size);
+
+  private:
+    char _camera[BLE_NAME_SIZE] = ""; // the one to connect to, empty for any
+    BLEClient *_client = NULL;
+    BLERemoteCharacteristic *_command = NULL;
+    BLERemoteCharacteristic *_response = NULL;
+
+    static Esp32BleLink *_links[ESP32_BLE_LINKS];
+    bool matches(BLEAdvertisedDevice &device);
+    static void onNotify(BLERemoteCharacteristic *characteristic, uint8_t *data, size_t size, bool is_notify);
+};
+
+#endif
+
+#endif //ESP32_BLE_LINK_H
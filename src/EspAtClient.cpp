@@ -0,0 +1,341 @@
+/*
+EspAtClient.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <GoProControl.h>
+
+EspAtClient::EspAtClient()
+{
+}
+
+uint8_t EspAtClient::begin(Stream &serial, const uint8_t link)
+{
+    _serial = &serial;
+    _link = link;
+
+    // multiple connections, WiFiEsp uses the same mode
+    startCommand("CIPMUX=1");
+    _serial->print("\r\n");
+    return waitFor("OK", 1000);
+}
+
+void EspAtClient::setKeepAlive(const bool enable)
+{
+    _keep_alive = enable;
+}
+
+int EspAtClient::connect(IPAddress ip, uint16_t port)
+{
+    char host[16];
+    snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    return connect(host, port);
+}
+
+int EspAtClient::connect(const char *host, uint16_t port)
+{
+    if (_serial == NULL)
+    {
+        return 0;
+    }
+
+    if (_open)
+    {
+        poll(); // maybe the camera closed it in the meantime
+    }
+    if (_open && _keep_alive && _port == port && strcmp(_host, host) == 0)
+    {
+        return 1; // same link, no AT round trip at all
+    }
+    if (_open)
+    {
+        close();
+    }
+
+    _head = _tail;
+    _stale = false;
+    startCommand("CIPSTART=");
+    _serial->print(_link);
+    _serial->print(",\"TCP\",\"");
+    _serial->print(host);
+    _serial->print("\",");
+    _serial->print(port);
+    _serial->print("\r\n");
+    if (waitFor("OK", _timeout) != true)
+    {
+        return 0;
+    }
+
+    strncpy(_host, host, sizeof(_host) - 1);
+    _host[sizeof(_host) - 1] = '\0';
+    _port = port;
+    _open = true;
+    return 1;
+}
+
+size_t EspAtClient::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t EspAtClient::write(const uint8_t *buffer, size_t size)
+{
+    if (!_open || size == 0)
+    {
+        return 0;
+    }
+
+    // what is still on the link until the prompt isn't the answer to this request
+    _head = _tail;
+    _stale = true;
+
+    startCommand("CIPSEND=");
+    _serial->print(_link);
+    _serial->print(',');
+    _serial->print((uint16_t)size);
+    _serial->print("\r\n");
+    if (waitFor(">", _timeout) != true)
+    {
+        return 0;
+    }
+    _head = _tail;
+    _stale = false;
+    _answer.reset(NULL, true);
+
+    _serial->write(buffer, size);
+    if (waitFor("SEND OK", _timeout) != true)
+    {
+        return 0;
+    }
+    return size;
+}
+
+int EspAtClient::available()
+{
+    if (_serial == NULL)
+    {
+        return 0;
+    }
+    poll();
+    return (_head + ESP_AT_BUFFER_SIZE - _tail) % ESP_AT_BUFFER_SIZE;
+}
+
+int EspAtClient::read()
+{
+    if (available() == 0)
+    {
+        return -1;
+    }
+    const uint8_t c = _buffer[_tail];
+    _tail = (_tail + 1) % ESP_AT_BUFFER_SIZE;
+    return c;
+}
+
+int EspAtClient::read(uint8_t *buffer, size_t size)
+{
+    size_t count = 0;
+    while (count < size && available() > 0)
+    {
+        buffer[count++] = read();
+    }
+    return count;
+}
+
+int EspAtClient::peek()
+{
+    if (available() == 0)
+    {
+        return -1;
+    }
+    return _buffer[_tail];
+}
+
+void EspAtClient::flush()
+{
+    // write() returns after SEND OK, nothing is waiting
+}
+
+void EspAtClient::stop()
+{
+    if (_open && _keep_alive)
+    {
+        // forget what is left of this answer, but keep the link only if all of it arrived:
+        // otherwise its end would come in front of the next answer
+        _head = _tail;
+        _stale = true;
+        poll();
+        if (_answer.reusable())
+        {
+            return;
+        }
+    }
+    close();
+}
+
+uint8_t EspAtClient::connected()
+{
+    return _open || available() > 0;
+}
+
+EspAtClient::operator bool()
+{
+    return _serial != NULL;
+}
+
+////////////////////////////////////////////////////////////
+////////                  Private                  /////////
+////////////////////////////////////////////////////////////
+
+uint8_t EspAtClient::close()
+{
+    if (_serial == NULL || !_open)
+    {
+        return true;
+    }
+
+    startCommand("CIPCLOSE=");
+    _serial->print(_link);
+    _serial->print("\r\n");
+    const uint8_t result = waitFor("OK", _timeout);
+    _open = false;
+    _head = _tail;
+    return result;
+}
+
+void EspAtClient::startCommand(const char *command)
+{
+    poll(); // whatever is already on the UART isn't the answer to this command
+    _line_ready = false;
+    _prompt = false;
+    _serial->print("AT+");
+    _serial->print(command);
+}
+
+// wait for a line starting with expected (or for the '>' prompt of CIPSEND), false on ERROR or timeout
+uint8_t EspAtClient::waitFor(const char *expected, const uint32_t timeout)
+{
+    bool already_connected = false;
+    const uint32_t start_time = millis();
+
+    while (millis() - start_time < timeout)
+    {
+        poll();
+
+        if (expected[0] == '>' && _prompt)
+        {
+            _prompt = false;
+            return true;
+        }
+        if (_line_ready == false)
+        {
+            continue;
+        }
+        _line_ready = false;
+
+        if (strncmp(_line, expected, strlen(expected)) == 0)
+        {
+            return true;
+        }
+        else if (strcmp(_line, "ALREADY CONNECTED") == 0)
+        {
+            already_connected = true; // an ERROR follows, but the link is there
+        }
+        else if (strcmp(_line, "ERROR") == 0 || strcmp(_line, "FAIL") == 0 || strcmp(_line, "SEND FAIL") == 0)
+        {
+            return already_connected ? true : false;
+        }
+    }
+    return false;
+}
+
+// read the UART until it is empty or a line is complete: +IPD frames of our link go in the buffer
+void EspAtClient::poll()
+{
+    while (_serial->available() > 0)
+    {
+        if (_ipd_remaining > 0)
+        {
+            const uint16_t next = (_head + 1) % ESP_AT_BUFFER_SIZE;
+            if (_ipd_ours && !_stale && next == _tail)
+            {
+                return; // buffer full, leave the rest in the UART until the caller reads
+            }
+
+            const uint8_t c = _serial->read();
+            _ipd_remaining--;
+            if (_ipd_ours)
+            {
+                _answer.feed(c);
+            }
+            if (_ipd_ours && !_stale)
+            {
+                _buffer[_head] = c;
+                _head = next;
+            }
+            continue;
+        }
+
+        const char c = _serial->read();
+        if (c == '\n')
+        {
+            endLine();
+            if (_line_ready)
+            {
+                return;
+            }
+        }
+        else if (c == '>' && _line_index == 0)
+        {
+            _prompt = true;
+        }
+        else if (c == ':' && _line_index > 5 && strncmp(_line, "+IPD,", 5) == 0)
+        {
+            // +IPD,<link>,<length>:<data>
+            _line[_line_index] = '\0';
+            const char *comma = strchr(_line + 5, ',');
+            if (comma != NULL)
+            {
+                _ipd_ours = (atoi(_line + 5) == _link);
+                _ipd_remaining = atoi(comma + 1);
+            }
+            _line_index = 0;
+        }
+        else if (c != '\r' && _line_index < sizeof(_line) - 1)
+        {
+            _line[_line_index++] = c;
+        }
+    }
+}
+
+void EspAtClient::endLine()
+{
+    _line[_line_index] = '\0';
+    _line_index = 0;
+    if (_line[0] == '\0')
+    {
+        return;
+    }
+
+    // "<link>,CLOSED": the camera closed our connection
+    if (_line[0] - '0' == _link && _line[1] == ',' && strcmp(_line + 2, "CLOSED") == 0)
+    {
+        _open = false;
+        return;
+    }
+    _line_ready = true;
+}
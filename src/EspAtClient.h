@@ -0,0 +1,82 @@
+/*
+EspAtClient.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ESP_AT_CLIENT_H
+#define ESP_AT_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <HttpResponse.h>
+
+// A TCP client that talks directly to an ESP01 with the AT firmware: a request is written with a
+// single AT+CIPSEND, the answer is read from the +IPD frames and, with keep alive, the link stays
+// open between requests. It uses its own link (ESP_AT_LINK) of AT+CIPMUX=1 so it can live
+// together with WiFiEsp, which is still used to join the access point
+class EspAtClient : public Client
+{
+  public:
+    EspAtClient();
+
+    uint8_t begin(Stream &serial, const uint8_t link = ESP_AT_LINK);
+    void setKeepAlive(const bool enable);
+
+    int connect(IPAddress ip, uint16_t port);
+    int connect(const char *host, uint16_t port);
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    int available();
+    int read();
+    int read(uint8_t *buffer, size_t size);
+    int peek();
+    void flush();
+    void stop();
+    uint8_t connected();
+    operator bool();
+
+  private:
+    Stream *_serial = NULL;
+    uint8_t _link = ESP_AT_LINK;
+    bool _open = false;
+    bool _keep_alive = true;
+    char _host[16] = "";
+    uint16_t _port = 0;
+
+    // data of our link, filled by poll()
+    uint8_t _buffer[ESP_AT_BUFFER_SIZE];
+    uint16_t _head = 0;
+    uint16_t _tail = 0;
+    bool _stale = false;   // the rest of an answer we don't want anymore
+    HttpResponse _answer; // the answer to the last request, the link is kept only once all of it arrived
+
+    // what poll() is reading from the UART
+    char _line[24];
+    uint8_t _line_index = 0;
+    bool _line_ready = false;
+    bool _prompt = false;
+    uint16_t _ipd_remaining = 0; // bytes of the current +IPD frame still to read
+    bool _ipd_ours = false;
+
+    void poll();
+    void endLine();
+    void startCommand(const char *command);
+    uint8_t waitFor(const char *expected, const uint32_t timeout);
+    uint8_t close();
+};
+
+#endif //ESP_AT_CLIENT_H
@@ -18,29 +18,156 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 
 #include <GoProControl.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Preferences.h>
+#elif (defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)) && defined(DETECT_EEPROM_ADDRESS)
+#include <EEPROM.h>
+#define DETECT_CACHE_EEPROM
+#endif
+#if !defined(IRAM_ATTR) // interrupt code in RAM, only ESP boards need it
+#define IRAM_ATTR
+#endif
+#if defined(__linux__) // host build: the camera groups wait on epoll
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
 #define LEN(x) ((sizeof(x) / sizeof(0 [x])) / ((size_t)(!(sizeof(x) % sizeof(0 [x])))))
 
+// default policy of every command_class, see setPolicy()
+// connect, first byte, deadline, retries, backoff, max backoff, jitter, idempotent
+static const RequestPolicy DEFAULT_POLICIES[command_class_last] = {
+    {MAX_WAIT_TIME, MAX_WAIT_TIME, 6000, 1, 500, 500, 25, false}, // CONTROL_COMMAND
+    {500, 1000, 1500, 1, 50, 50, 0, false},                       // SHUTTER_COMMAND
+    {1000, MAX_WAIT_TIME, 8000, 3, 250, 2000, 25, true},          // SETTING_COMMAND
+    {1000, MAX_WAIT_TIME, 5000, 2, 250, 1000, 25, true},          // STATUS_COMMAND
+};
+
+// the status values of CameraStatus, in the order of status_field
+static const StatusField STATUS_FIELDS[] = {{"status", "8"}, {"status", "43"}, {"status", "70"}, {"status", "35"}};
+
+static void decodeStatus(StatusParser &parser, char (*values)[STATUS_VALUE_SIZE], CameraStatus &status)
+{
+    if (parser.found(0))
+    {
+        status.recording = atoi(values[0]);
+    }
+    if (parser.found(1))
+    {
+        status.mode = atoi(values[1]);
+    }
+    if (parser.found(2))
+    {
+        status.battery = atoi(values[2]);
+    }
+    if (parser.found(3))
+    {
+        status.video_left = atol(values[3]);
+    }
+}
+
+// the class of the policy of a command without options
+static uint8_t commandClass(const uint8_t command)
+{
+    if (command == CMD_SHUTTER_ON || command == CMD_SHUTTER_OFF)
+    {
+        return SHUTTER_COMMAND;
+    }
+    else if (command == CMD_STATUS || command == CMD_INFO)
+    {
+        return STATUS_COMMAND;
+    }
+    else if (command == CMD_TAG_MOMENT)
+    {
+        return SHUTTER_COMMAND; // like the shutter: fail fast and never resent
+    }
+    return CONTROL_COMMAND;
+}
+
+// days since 1970-01-01 and back, from http://howardhinnant.github.io/date_algorithms.html
+static int32_t daysFromCivil(int32_t year, const uint8_t month, const uint8_t day)
+{
+    year -= month <= 2;
+    const int32_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint32_t yoe = year - era * 400;
+    const uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+static void civilFromDays(int32_t days, uint16_t &year, uint8_t &month, uint8_t &day)
+{
+    days += 719468;
+    const int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const uint32_t doe = days - era * 146097;
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = yoe + era * 400 + (month <= 2);
+}
+
+// strncpy() that always ends the string, NULL is an empty one
+static void copyText(char buffer[], const size_t size, const char *text)
+{
+    strncpy(buffer, text != NULL ? text : "", size - 1);
+    buffer[size - 1] = '\0';
+}
+
 ////////////////////////////////////////////////////////////
 ////////                Constructors                ////////
 ////////////////////////////////////////////////////////////
 
-GoProControl::GoProControl(const String ssid, const String pwd, const uint8_t camera, const uint8_t gopro_mac[], const String board_name)
+// the strings are copied, the sketch can build them in a buffer that goes away afterwards
+GoProControl::GoProControl(const char *ssid, const char *pwd, const uint8_t camera, const uint8_t gopro_mac[], const char *board_name)
+    : _client_transport(_wifi_client, _udp_client)
+{
+    copyText(_ssid_buffer, LEN(_ssid_buffer), ssid);
+    copyText(_pwd_buffer, LEN(_pwd_buffer), pwd);
+    _ssid = _ssid_buffer;
+    _pwd = _pwd_buffer;
+    copyText(_board_name, LEN(_board_name), board_name);
+    setup(camera, gopro_mac);
+}
+
+// credentials in flash, not copied: GoProControl gp(F("ssid"), F("password"), HERO5);
+GoProControl::GoProControl(const __FlashStringHelper *ssid, const __FlashStringHelper *pwd, const uint8_t camera, const uint8_t gopro_mac[], const char *board_name)
+    : _client_transport(_wifi_client, _udp_client)
+{
+    _ssid = (const char *)ssid;
+    _pwd = (const char *)pwd;
+    _progmem_credentials = true;
+    copyText(_board_name, LEN(_board_name), board_name);
+    setup(camera, gopro_mac);
+}
+
+// the API of the first versions, the String objects are copied in the same buffers
+GoProControl::GoProControl(const String &ssid, const String &pwd, const uint8_t camera, const uint8_t gopro_mac[], const String &board_name)
+    : GoProControl(ssid.c_str(), pwd.c_str(), camera, gopro_mac, board_name.c_str())
+{
+}
+
+void GoProControl::setup(const uint8_t camera, const uint8_t gopro_mac[])
 {
-    _ssid = ssid;
-    _pwd = pwd;
     _camera = camera;
 
-    if (gopro_mac == NULL)
+    if (gopro_mac != NULL)
     {
-        memset(_gopro_mac, NULL, 6 * sizeof(*_gopro_mac));
+        macCopy(_gopro_mac, gopro_mac);
+        _gopro_mac_given = true;
     }
-    else
-    {
-        memcpy(_gopro_mac, gopro_mac, LEN(gopro_mac));
-    }
-    _board_name = board_name;
 
-    memset(_board_mac, NULL, 6 * sizeof(*_board_mac));
+    memcpy(_policies, DEFAULT_POLICIES, sizeof(_policies));
+    _detect = (_camera == AUTO_DETECT);
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_BLE)
+    _ble.setLink(&_esp32_ble_link); // GOPRO_BLE turns GOPRO_BLE_CONTROL on
+#endif
+#if !defined(GOPRO_GPCONTROL_ONLY)
+    char pwd[WIFI_PASSWORD_SIZE];
+    readCredential(pwd, LEN(pwd), _pwd);
+    _auth_length = Hero3Dialect::buildAuth(_auth, LEN(_auth), pwd);
+#endif
+    _capabilities.load(_camera);
 }
 
 ////////////////////////////////////////////////////////////
@@ -58,7 +185,7 @@ uint8_t GoProControl::begin()
         return false;
     }
 
-    if (_camera <= HERO2)
+    if (_camera != AUTO_DETECT && _camera <= HERO2)
     {
         if (_debug)
         {
@@ -67,16 +194,41 @@ uint8_t GoProControl::begin()
         return -1;
     }
 
+#if defined(GOPRO_HERO3_ONLY) || defined(GOPRO_GPCONTROL_ONLY)
+    if (_camera != AUTO_DETECT && (_camera == HERO3) != HERO3_DIALECT)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Camera not supported by this build, see Settings.h");
+        }
+        return -1;
+    }
+#endif
+
+    if (_camera == HERO3 && _auth_length == 0)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Password too long, see HERO3_AUTH_SIZE");
+        }
+        return -1;
+    }
+
     if (_debug)
     {
-        _debug_port->println("Attempting to connect to SSID: " + _ssid);
-        _debug_port->println("using password: " + _pwd);
+        _debug_port->print("Attempting to connect to SSID: ");
+        printCredential(_ssid);
+        _debug_port->print("using password: ");
+        printCredential(_pwd);
     }
 
-    WiFi.begin(_ssid.c_str(), _pwd.c_str());
+    accountRadio();
+    _wanted = true;
+    setState(CAMERA_ASSOCIATING);
+    startWiFi();
 
     uint32_t start_time = millis();
-    while (WiFi.status() != WL_CONNECTED && start_time + MAX_WAIT_TIME > millis())
+    while (WiFi.status() != WL_CONNECTED && millis() - start_time < _policies[CONTROL_COMMAND].connect_timeout)
     {
         if (_debug)
         {
@@ -92,6 +244,16 @@ uint8_t GoProControl::begin()
             _debug_port->println("\nConnected to GoPro");
         }
         _connected = true;
+        _failed_requests = 0;
+        _reconnect_delay = RECONNECT_MIN_DELAY;
+        _wifi_used_at = millis();
+        setState(CAMERA_CONNECTED);
+
+        if (_camera == AUTO_DETECT && detectCamera() != true)
+        {
+            end();
+            return -1;
+        }
         return true;
     }
     else
@@ -102,6 +264,7 @@ uint8_t GoProControl::begin()
             _debug_port->println(WiFi.status());
         }
         _connected = false;
+        setState(CAMERA_DISCONNECTED);
     }
 
     return -(WiFi.status());
@@ -109,8 +272,15 @@ uint8_t GoProControl::begin()
 
 void GoProControl::end()
 {
+    accountRadio();
+    _wanted = false; // stop the automatic reconnection
+#if defined(GOPRO_SCHEDULE)
+    disarmTrigger();
+#endif
+
     if (!checkConnection())
     {
+        setState(CAMERA_DISCONNECTED);
         return;
     }
 
@@ -118,49 +288,170 @@ void GoProControl::end()
     {
         _debug_port->println("Closing connection");
     }
-    _udp_client.stop();
-    _wifi_client.stop();
+    _transport->close();
     WiFi.disconnect();
     _connected = false;
-    memset(_gopro_mac, NULL, 6 * sizeof(*_gopro_mac));
+    setState(CAMERA_DISCONNECTED);
+    if (!_gopro_mac_given) // the next access point may be another camera
+    {
+        macClear(_gopro_mac);
+    }
 }
 
 uint8_t GoProControl::keepAlive()
 {
-    if (!checkConnection(true)) // camera not connected
+    monitorConnection();
+
+    if (WIFI_MODE == false) // the access point is off, nothing to keep alive
+    {
+        return false;
+    }
+
+#if defined(GOPRO_BLE_CONTROL)
+    if (_power_saving && BLE_ENABLED && !_scheduled && millis() - _wifi_used_at >= _wifi_idle)
+    {
+        if (_debug)
+        {
+            _debug_port->println("WiFi idle, turning it off");
+        }
+        if (wifiOff() != true)
+        {
+            _wifi_used_at = millis(); // try again after another idle period
+        }
+        return false;
+    }
+#endif
+
+    if (!checkConnection(true) || _scheduled || _trigger_armed) // camera not connected or busy with a scheduled or armed shot
     {
         return false;
     }
 
-    if (millis() - _last_request <= KEEP_ALIVE) // we made a request not so much earlier
+#if defined(GOPRO_STATUS_EVENTS)
+    // a status read keeps the connection alive as well
+    if (_status_subscriptions[0].callback != NULL && _state != CAMERA_ASLEEP &&
+        millis() - _status_polled_at >= STATUS_POLL_INTERVAL)
+    {
+        return isOn();
+    }
+#endif
+
+    // a sleeping camera is probed with the reconnection backoff, not every KEEP_ALIVE
+    const uint32_t interval = (_state == CAMERA_ASLEEP) ? _reconnect_delay : KEEP_ALIVE;
+    if (millis() - _last_request <= interval) // we made a request not so much earlier
     {
         return false;
     }
     else // time to ask something to the camera
     {
-        if (_camera == HERO3)
+        if (!DIALECT(keep_alive))
         {
             // not needed since the connection won't be closed by the camera (tested for more then 6 minutes)
             return true;
         }
-        else if (_camera >= HERO4)
+        else
         {
             if (_debug)
             {
                 _debug_port->println("Keeping connection alive");
             }
-            sendRequest("_GPHD_:0:0:2:0.000000\n");
+            return sendRequest("_GPHD_:0:0:2:0.000000\n");
+        }
+    }
+    return false;
+}
+
+void GoProControl::setTransport(Transport *transport)
+{
+    _transport->close();
+    if (transport == NULL)
+    {
+        transport = &_client_transport;
+    }
+
+#if defined(GOPRO_RECORDER)
+    if (_transport == &_recorder) // keep recording, now this one
+    {
+        _recorder.setTransport(transport);
+        return;
+    }
+#endif
+    _transport = transport;
+}
+
+#if defined(GOPRO_RECORDER)
+// everything said to the camera and its answers go to log, see RecordingTransport and ReplayTransport
+void GoProControl::startRecording(Print &log)
+{
+    _recorder.begin(_transport == &_recorder ? _recorder.getTransport() : _transport, &log);
+    _transport = &_recorder;
+}
+
+void GoProControl::stopRecording()
+{
+    if (_transport == &_recorder)
+    {
+        _transport = _recorder.getTransport();
+    }
+}
+#endif
+
+#if defined(AT_COMMAND) && defined(GOPRO_ESP_AT_CLIENT)
+uint8_t GoProControl::setEspSerial(Stream &serial, const bool keep_alive)
+{
+    // the same serial given to WiFi.init(), WiFiEsp still joins the access point
+    _wifi_client.setKeepAlive(keep_alive);
+    if (_wifi_client.begin(serial) != true)
+    {
+        if (_debug)
+        {
+            _debug_port->println("The ESP01 doesn't answer to AT+CIPMUX=1");
         }
+        return false;
     }
+    return true;
+}
+#endif
+
+uint8_t GoProControl::getState()
+{
+    return _state;
+}
+
+void GoProControl::onStateChange(StateCallback callback)
+{
+    _state_callback = callback;
+}
+
+void GoProControl::setAutoReconnect(const bool enable)
+{
+    _auto_reconnect = enable;
 }
 
 ////////////////////////////////////////////////////////////
 ////////                    BLE                    /////////
 ////////////////////////////////////////////////////////////
 
-#if defined(ARDUINO_ARCH_ESP32)
-// none of these function will work, I am adding these for a future release, see the readME
-// https://github.com/KonradIT/goprowifihack/blob/master/HERO5/HERO5-Commands.md#bluetooth-pairing
+#if defined(GOPRO_BLE_CONTROL)
+void GoProControl::setBleLink(BleLink *link)
+{
+    if (_ble.link() != NULL)
+    {
+        _ble.link()->disconnect();
+    }
+    accountRadio();
+    BLE_ENABLED = false;
+    _ble.setLink(link);
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_BLE)
+// with several cameras around, the one enableBLE() connects to: its name ("GoPro 1234") or address
+void GoProControl::setBleCamera(const char *camera)
+{
+    _esp32_ble_link.select(camera);
+}
+#endif
+
 uint8_t GoProControl::enableBLE()
 {
     if (_camera <= HERO3)
@@ -171,7 +462,27 @@ uint8_t GoProControl::enableBLE()
         }
         return false;
     }
+
+    if (_ble.link() == NULL)
+    {
+        if (_debug)
+        {
+            _debug_port->println("No BLE link, see setBleLink()");
+        }
+        return false;
+    }
+
+    if (!_ble.link()->connect(BLE_CONNECT_TIMEOUT))
+    {
+        if (_debug)
+        {
+            _debug_port->println("Camera not found over BLE, is it in pairing mode?");
+        }
+        return false;
+    }
+    accountRadio();
     BLE_ENABLED = true;
+    return true;
 }
 
 uint8_t GoProControl::disableBLE()
@@ -184,7 +495,23 @@ uint8_t GoProControl::disableBLE()
         }
         return false;
     }
+
+    if (WIFI_MODE == false) // the camera would be unreachable
+    {
+        if (_debug)
+        {
+            _debug_port->println("First run wifiOn()");
+        }
+        return false;
+    }
+
+    if (_ble.link() != NULL)
+    {
+        _ble.link()->disconnect();
+    }
+    accountRadio();
     BLE_ENABLED = false;
+    return true;
 }
 
 uint8_t GoProControl::wifiOff()
@@ -207,8 +534,23 @@ uint8_t GoProControl::wifiOff()
         return false;
     }
 
+    const uint8_t result = sendBLERequest(BLE_WiFiOff, LEN(BLE_WiFiOff), CONTROL_COMMAND);
+    if (result != true)
+    {
+        return result;
+    }
+
+    // the access point is going down: leave it, monitorConnection() waits for wifiOn()
+    accountRadio();
     WIFI_MODE = false;
-    sendBLERequest(BLE_WiFiOff);
+    _transport->close();
+    if (_connected)
+    {
+        WiFi.disconnect();
+        _connected = false;
+    }
+    setState(CAMERA_DISCONNECTED);
+    return true;
 }
 
 uint8_t GoProControl::wifiOn()
@@ -221,54 +563,168 @@ uint8_t GoProControl::wifiOn()
         }
         return false;
     }
+
+    if (BLE_ENABLED == false)
+    {
+        if (_debug)
+        {
+            _debug_port->println("First run enableBLE()");
+        }
+        return false;
+    }
+
+    const uint8_t result = sendBLERequest(BLE_WiFiOn, LEN(BLE_WiFiOn), CONTROL_COMMAND);
+    if (result != true)
+    {
+        return result;
+    }
+
+    // the camera needs a few seconds for the access point, monitorConnection() joins it again
+    accountRadio();
     WIFI_MODE = true;
-    sendBLERequest(BLE_WiFiOn);
+    _state_since = millis() - _reconnect_delay;
+    return true;
 }
-#endif
 
 ////////////////////////////////////////////////////////////
-////////                  Control                  /////////
+////////               Power saving                /////////
 ////////////////////////////////////////////////////////////
 
-uint8_t GoProControl::turnOn()
+// With BLE enabled the access point of the camera stays off: shutter and mode go over Bluetooth,
+// anything else (status, settings, deletes, ...) turns the WiFi on first and keepAlive() turns it
+// off again after idle_timeout milliseconds without requests
+void GoProControl::setPowerSaving(const bool enable, const uint32_t idle_timeout)
 {
-    if (!checkConnection()) // not connected
+    _power_saving = enable;
+    _wifi_idle = idle_timeout;
+    _wifi_used_at = millis();
+}
+
+uint8_t GoProControl::wakeWiFi()
+{
+    if (WIFI_MODE && _connected)
+    {
+        _wifi_used_at = millis();
+        return true;
+    }
+
+    if (_wanted == false)
     {
         if (_debug)
         {
-            _debug_port->println("Connect the camera first");
+            _debug_port->println("First run begin()");
         }
         return false;
     }
 
-    if (_camera == HERO3)
+    if (WIFI_MODE == false && wifiOn() != true)
     {
-        _request = "/bacpac/PW?t=" + _pwd + "&p=%01";
+        return false;
     }
-    else if (_camera >= HERO4)
+
+    if (_debug)
     {
-        if (_gopro_mac[0] == 0)
-        {
-            if (_debug)
-            {
-                _debug_port->println("No BSSID, unable to turn on the camera");
+        _debug_port->println("Waiting for the access point of the camera");
+    }
+    const uint32_t start_time = millis();
+    while (!_connected && millis() - start_time < WIFI_WAKE_TIMEOUT)
+    {
+        monitorConnection();
+        delay(100);
+    }
+
+    _wifi_used_at = millis();
+    return _connected;
+}
+
+void GoProControl::getRadioTime(uint32_t &wifi, uint32_t &ble)
+{
+    accountRadio();
+    wifi = _wifi_time;
+    ble = _ble_time;
+}
+#endif // GOPRO_BLE_CONTROL
+
+////////////////////////////////////////////////////////////
+////////                 Detection                  ////////
+////////////////////////////////////////////////////////////
+
+// the cached result of detectCamera(), valid only for the same SSID
+struct DetectedCamera
+{
+    uint8_t magic;
+    uint8_t camera;
+    uint16_t ssid_hash;
+    char model_name[STATUS_VALUE_SIZE];
+    char firmware[STATUS_VALUE_SIZE];
+};
+#define DETECT_MAGIC 0xD5
+
+#if defined(DETECT_CACHE_EEPROM)
+// ESP8266 works on a RAM copy of the EEPROM: the one of the sketch if it opened it, otherwise
+// one opened only for this access. False if the one of the sketch is too short for the cache
+static bool beginEeprom(bool &opened)
+{
 #if defined(ARDUINO_ARCH_ESP8266)
-                _debug_port->println("The ESP8266 can't get it, you need to pass it in the constructor, see the README");
+    opened = (EEPROM.length() == 0);
+    if (opened)
+    {
+        EEPROM.begin(DETECT_EEPROM_ADDRESS + sizeof(DetectedCamera));
+    }
+#else
+    opened = false;
 #endif
-            }
-            return false;
-        }
-        else
+    return EEPROM.length() >= DETECT_EEPROM_ADDRESS + sizeof(DetectedCamera);
+}
+
+static void endEeprom(const bool opened, const bool written)
+{
+#if defined(ARDUINO_ARCH_ESP8266)
+    if (written)
+    {
+        EEPROM.commit();
+    }
+    if (opened) // never the buffer of the sketch
+    {
+        EEPROM.end();
+    }
+#endif
+}
+#endif
+
+// FNV-1a folded to 16 bits
+static uint16_t hashString(const char *text)
+{
+    uint32_t hash = 2166136261UL;
+    while (*text != '\0')
+    {
+        hash ^= (uint8_t)*text++;
+        hash *= 16777619UL;
+    }
+    return (hash >> 16) ^ (hash & 0xFFFF);
+}
+
+// "HERO5 Black", "HERO7 Silver", "HERO11 Black", "FUSION"... newer models speak the same gpControl as the HERO7
+static uint8_t cameraFromModel(const char *model)
+{
+    if (strstr(model, "FUSION") != NULL || strstr(model, "Fusion") != NULL)
+    {
+        return FUSION;
+    }
+
+    const char *hero = strstr(model, "HERO");
+    if (hero != NULL && hero[4] >= '0' && hero[4] <= '9')
+    {
+        const int number = min(atoi(hero + 4), 99); // the whole number, HERO10 isn't a HERO1
+        if (number >= 5)
         {
-            sendWoL();
-            return true;
+            return min(HERO4 + (number - 4), (int)HERO7);
         }
     }
-
-    return sendHTTPRequest(_request);
+    return HERO4; // HERO4, HERO+, HERO 2018 and friends: the oldest gpControl camera is the safest guess
 }
 
-uint8_t GoProControl::turnOff(const bool force)
+uint8_t GoProControl::detectCamera()
 {
     if (!checkConnection()) // not connected
     {
@@ -279,32 +735,148 @@ uint8_t GoProControl::turnOff(const bool force)
         return false;
     }
 
-    if (_camera == HERO3)
-    {
-        _request = "/bacpac/PW?t=" + _pwd + "&p=%00";
-    }
-    else if (_camera >= HERO4)
+#if defined(GOPRO_HERO3_ONLY)
+    _camera = HERO3; // nothing else in this build
+#else
+    if (!loadDetectedCamera())
     {
-        if (_gopro_mac[0] == 0 && force == false)
+        if (probeCamera() != true)
         {
-            getBSSID();
             if (_debug)
             {
-                _debug_port->println("BSSID not ready, try again");
+                _debug_port->println("Unable to detect the camera, is it on?");
             }
+            _camera = AUTO_DETECT;
             return false;
         }
-        else if (_gopro_mac[0] == 0 && force)
-        {
+        saveDetectedCamera();
+    }
+#endif
+
+    if (_camera == HERO3 && _auth_length == 0) // begin() could only check it with the model given
+    {
+        if (_debug)
+        {
+            _debug_port->println("Password too long, see HERO3_AUTH_SIZE");
+        }
+        _camera = AUTO_DETECT;
+        return -1;
+    }
+
+    _capabilities.load(_camera);
+    if (_debug)
+    {
+        _debug_port->print("Camera: ");
+#if defined(GOPRO_CAMERA_INFO)
+        _debug_port->println(_model_name);
+#else
+        _debug_port->println(_camera);
+#endif
+    }
+    return true;
+}
+
+uint8_t GoProControl::getCamera()
+{
+    return _camera;
+}
+
+void GoProControl::forgetCamera()
+{
+    if (!_detect) // the cache is only used with AUTO_DETECT
+    {
+        return;
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    Preferences preferences;
+    preferences.begin("GoProControl", false);
+    preferences.remove("camera");
+    preferences.end();
+#elif defined(DETECT_CACHE_EEPROM)
+    bool opened;
+    const bool ours = beginEeprom(opened) && EEPROM.read(DETECT_EEPROM_ADDRESS) == DETECT_MAGIC;
+    if (ours) // a byte of the sketch is left alone
+    {
+        EEPROM.write(DETECT_EEPROM_ADDRESS, 0);
+    }
+    endEeprom(opened, ours);
+#endif
+
+    _camera = AUTO_DETECT; // detect it again at the next begin()
+    _capabilities.load(_camera);
+}
+
+////////////////////////////////////////////////////////////
+////////                  Control                  /////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::turnOn()
+{
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    if (!HERO3_DIALECT) // HERO4 and newer are woken up with a wake on lan packet
+    {
+        if (macIsEmpty(_gopro_mac))
+        {
+            if (_debug)
+            {
+                _debug_port->println("No BSSID, unable to turn on the camera");
+#if defined(ARDUINO_ARCH_ESP8266)
+                _debug_port->println("The ESP8266 can't get it, you need to pass it in the constructor, see the README");
+#endif
+            }
+            return false;
+        }
+        else
+        {
+            sendWoL();
+            return true;
+        }
+    }
+
+    return sendCommand(CMD_POWER_ON, CONTROL_COMMAND);
+}
+
+uint8_t GoProControl::turnOff(const bool force)
+{
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    if (!HERO3_DIALECT)
+    {
+        if (macIsEmpty(_gopro_mac) && force == false)
+        {
+            getBSSID();
+            if (_debug)
+            {
+                _debug_port->println("BSSID not ready, try again");
+            }
+            return false;
+        }
+        else if (macIsEmpty(_gopro_mac) && force)
+        {
             if (_debug)
             {
                 _debug_port->println("Forcing turnOff, you won't be able to turnOn again from arduino");
             }
         }
-        _request = "/gp/gpControl/command/system/sleep";
     }
 
-    return sendHTTPRequest(_request);
+    return sendCommand(CMD_POWER_OFF, CONTROL_COMMAND);
 }
 
 uint8_t GoProControl::isOn()
@@ -318,21 +890,105 @@ uint8_t GoProControl::isOn()
         return false;
     }
 
-    if (_camera == HERO3)
+#if defined(GOPRO_STATUS_EVENTS)
+    _status_polled_at = millis();
+#endif
+    if (HERO3_DIALECT)
     {
         // this isn't supported by this camera so this function will always return true
         return true;
     }
-    else if (_camera >= HERO4)
+
+    // the answer is read anyway: keep the fields of CameraStatus
+    char values[LEN(STATUS_FIELDS)][STATUS_VALUE_SIZE];
+    StatusParser parser(STATUS_FIELDS, LEN(STATUS_FIELDS), values);
+    const uint8_t result = sendCommand(CMD_STATUS, STATUS_COMMAND, &parser);
+    if (result == true)
+    {
+        CameraStatus status = _status;
+        status.code = 200;
+        status.round_trip = _round_trip;
+        decodeStatus(parser, values, status);
+        updateStatus(status);
+    }
+    return result;
+}
+
+#if defined(GOPRO_STATUS_EVENTS)
+// keepAlive() reads the status every STATUS_POLL_INTERVAL ms and the callback gets the fields of
+// field_mask that changed since the previous read (HERO4 and newer)
+uint8_t GoProControl::onStatusChange(const uint8_t field_mask, StatusCallback callback)
+{
+    for (uint8_t i = 0; i < STATUS_SUBSCRIPTIONS; i++)
+    {
+        if (_status_subscriptions[i].callback == NULL)
+        {
+            _status_subscriptions[i].mask = field_mask;
+            _status_subscriptions[i].callback = callback;
+            return true;
+        }
+    }
+
+    if (_debug)
+    {
+        _debug_port->println("Too many status callbacks");
+    }
+    return false;
+}
+#endif
+
+const CameraStatus &GoProControl::getStatus()
+{
+    return _status;
+}
+
+// milliseconds until keepAlive() has something to do, for a TimerWheel: calling it earlier
+// is harmless, later delays the keep alive, the status poll or the reconnection
+uint32_t GoProControl::nextKeepAlive()
+{
+    const uint32_t now = millis();
+    uint32_t next = KEEP_ALIVE;
+
+    if (_wanted && WIFI_MODE && _state == CAMERA_ASSOCIATING)
+    {
+        return 0; // watch the association
+    }
+    if (_wanted && WIFI_MODE && _state == CAMERA_DISCONNECTED && _auto_reconnect)
+    {
+        return max((int32_t)(_reconnect_delay - (now - _state_since)), (int32_t)0);
+    }
+    if (WIFI_MODE == false || _connected == false || _scheduled || _trigger_armed)
     {
-        _request = "/gp/gpControl/status";
+        return next;
     }
 
-    return sendHTTPRequest(_request);
+    if (_power_saving && BLE_ENABLED)
+    {
+        next = min(next, (uint32_t)max((int32_t)(_wifi_idle - (now - _wifi_used_at)), (int32_t)0));
+    }
+#if defined(GOPRO_STATUS_EVENTS)
+    if (_status_subscriptions[0].callback != NULL && _state != CAMERA_ASLEEP)
+    {
+        next = min(next, (uint32_t)max((int32_t)(STATUS_POLL_INTERVAL - (now - _status_polled_at)), (int32_t)0));
+    }
+#endif
+    if (DIALECT(keep_alive))
+    {
+        const uint32_t interval = (_state == CAMERA_ASLEEP) ? _reconnect_delay : KEEP_ALIVE;
+        next = min(next, (uint32_t)max((int32_t)(interval + 1 - (uint32_t)(now - _last_request)), (int32_t)0));
+    }
+    return next;
 }
 
 uint8_t GoProControl::checkConnection(const bool silent)
 {
+#if defined(GOPRO_BLE_CONTROL)
+    if (_connected == false && _power_saving && WIFI_MODE == false && _wanted)
+    {
+        wakeWiFi(); // a WiFi request while the access point sleeps
+    }
+#endif
+
     if (_connected == true)
     {
         if (_debug && silent == false)
@@ -357,6 +1013,11 @@ uint8_t GoProControl::checkConnection(const bool silent)
 
 uint8_t GoProControl::shoot()
 {
+    if (useBLE())
+    {
+        return sendBLERequest(BLE_RecordStart, LEN(BLE_RecordStart), SHUTTER_COMMAND);
+    }
+
     if (!checkConnection()) // not connected
     {
         if (_debug)
@@ -366,35 +1027,54 @@ uint8_t GoProControl::shoot()
         return false;
     }
 
-    if (WIFI_MODE)
-    {
-
-        if (_camera == HERO3)
-        {
-            _request = "/bacpac/SH?t=" + _pwd + "&p=%01";
-        }
-        else if (_camera >= HERO4)
-        {
-            _request = "/gp/gpControl/command/shutter?p=1";
-        }
+    return sendCommand(CMD_SHUTTER_ON, SHUTTER_COMMAND);
+}
 
-        return sendHTTPRequest(_request);
+uint8_t GoProControl::stopShoot()
+{
+    if (useBLE())
+    {
+        return sendBLERequest(BLE_RecordStop, LEN(BLE_RecordStop), SHUTTER_COMMAND);
     }
-    else // BLE
+
+    if (!checkConnection()) // not connected
     {
-#if defined(ARDUINO_ARCH_ESP32)
-        sendBLERequest(BLE_RecordStart);
-#else
         if (_debug)
         {
-            _debug_port->println("This shouldn't be run");
+            _debug_port->println("Connect the camera first");
         }
-        return -1;
-#endif
+        return false;
     }
+
+    return sendCommand(CMD_SHUTTER_OFF, SHUTTER_COMMAND);
 }
 
-uint8_t GoProControl::stopShoot()
+// Like shoot() and stopShoot() but the camera must also show it: a 200 only says that the
+// command was accepted, the camera can still not record (SD card full, too hot, busy).
+// true: confirmed, false: command not accepted, -1: accepted but the state didn't change
+uint8_t GoProControl::shootAndConfirm(const uint16_t deadline)
+{
+    return confirmRecording(true, deadline);
+}
+
+uint8_t GoProControl::stopAndConfirm(const uint16_t deadline)
+{
+    return confirmRecording(false, deadline);
+}
+
+// from the command to the camera showing the new state, the real value is within +-lastConfirmUncertainty()
+uint16_t GoProControl::lastConfirmLatency()
+{
+    return _confirm_latency;
+}
+
+uint16_t GoProControl::lastConfirmUncertainty()
+{
+    return _confirm_uncertainty;
+}
+
+#if defined(GOPRO_SCHEDULE)
+uint8_t GoProControl::scheduleShoot(const uint32_t at_millis)
 {
     if (!checkConnection()) // not connected
     {
@@ -405,254 +1085,454 @@ uint8_t GoProControl::stopShoot()
         return false;
     }
 
-    if (WIFI_MODE)
+    if (_scheduled || _trigger_armed)
     {
-
-        if (_camera == HERO3)
+        if (_debug)
         {
-            _request = "/bacpac/SH?t=" + _pwd + "&p=%00";
+            _debug_port->println("A shot is already scheduled or armed");
         }
-        else if (_camera >= HERO4)
+        return false;
+    }
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_schedule_task != NULL)
+    {
+        if (_debug)
         {
-            _request = "/gp/gpControl/command/shutter?p=0";
+            _debug_port->println("The last scheduled shot is still closing its connection");
         }
+        return false;
+    }
+#endif
 
-        return sendHTTPRequest(_request);
+    // serialize now, at the deadline there will be only a write()
+    if (!prepareShutter())
+    {
+        return false;
     }
-    else // BLE
+    _scheduled_at = at_millis;
+    _preopened = false;
+    _scheduled = true;
+
+    if (_debug)
     {
+        _debug_port->print("Shot scheduled in ");
+        _debug_port->print((int32_t)(at_millis - millis()));
+        _debug_port->println(" ms");
+    }
+
 #if defined(ARDUINO_ARCH_ESP32)
-        sendBLERequest(BLE_RecordStop);
-#else
+    // fire from a high priority task instead of the next loop()
+    if (xTaskCreate(scheduleTask, "gopro_shoot", 4096, this, configMAX_PRIORITIES - 1, &_schedule_task) != pdPASS)
+    {
+        _schedule_task = NULL;
         if (_debug)
         {
-            _debug_port->println("This shouldn't be run");
+            _debug_port->println("Unable to start the task, call handleSchedule() in loop()");
         }
-        return -1;
-#endif
     }
+#endif
+    return true;
 }
 
-////////////////////////////////////////////////////////////
-////////                  Settings                  ////////
-////////////////////////////////////////////////////////////
-
-uint8_t GoProControl::setMode(const uint8_t option)
+uint8_t GoProControl::handleSchedule()
 {
-    if (!checkConnection()) // not connected
+    if (_scheduled == false)
     {
-        if (_debug)
-        {
-            _debug_port->println("Connect the camera first");
-        }
         return false;
     }
 
-    if (WIFI_MODE)
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_schedule_task != NULL && xTaskGetCurrentTaskHandle() != _schedule_task)
     {
+        return false; // the task takes care of it
+    }
+#endif
 
-        if (_camera == HERO3)
-        {
-            switch (option)
-            {
-            case VIDEO_MODE:
-                _parameter = "00";
-                break;
-            case PHOTO_MODE:
-                _parameter = "01";
-                break;
-            case BURST_MODE:
-                _parameter = "02";
-                break;
-            case TIMELAPSE_MODE:
-                _parameter = "03";
-                break;
-            case TIMER_MODE:
-                _parameter = "04";
-                break;
-            case PLAY_HDMI_MODE:
-                _parameter = "05";
-                break;
-            default:
-                if (_debug)
-                {
-                    _debug_port->println("Wrong parameter for setMode");
-                }
-                return -1;
-            }
+    const int32_t remaining = (int32_t)(_scheduled_at - millis());
 
-            _request = "camera/CM?t=" + _pwd + "&p=%" + _parameter;
-        }
-        else if (_camera >= HERO4)
+    if (_preopened == false && remaining <= SCHEDULE_PREOPEN)
+    {
+        if (!connectClient(_policies[SHUTTER_COMMAND].connect_timeout))
         {
-            _parameter2 = "";
-            switch (option)
-            {
-              case VIDEO_MODE:
-                  _parameter = "0";
-                  break;
-              case VIDEO_SUB_MODE:
-                  _parameter = "0";
-                  _parameter2 = "0";
-                  break;
-              case VIDEO_TIMELAPSE_MODE:
-                  _parameter = "0";
-                  _parameter2 = "1";
-                  break;
-              case VIDEO_PHOTO_MODE:
-                  // not supported by HERO6 and above
-                  _parameter = "0";
-                  _parameter2 = "2";
-                  break;
-              case VIDEO_LOOPING_MODE:
-                  // HERO7_BLACK and presumably above
-                  _parameter = "0";
-                  _parameter2 = "3";
-                  break;
-              case VIDEO_TIMEWARP_MODE:
-                  // HERO7_BLACK and presumably above
-                  _parameter = "0";
-                  _parameter2 = "4";
-                  break;
-
-              case PHOTO_MODE:
-                  _parameter = "1";
-                  break;
-              case PHOTO_SINGLE_MODE:
-                  _parameter = "1";
-                  _parameter2 = "1";
-                  break;
-              case PHOTO_NIGHT_MODE:
-                  // HERO7_BLACK and presumably above
-                  _parameter = "1";
-                  _parameter2 = "2";
-                  break;
-
-              case MULTISHOT_MODE:
-                  _parameter = "2";
-                  break;
-              case MULTISHOT_BURST_MODE:
-                  _parameter = "2";
-                  _parameter2 = "0";
-                  break;
-              case MULTISHOT_TIMELAPSE_MODE:
-                  // HERO7_BLACK and presumably above
-                  _parameter = "2";
-                  _parameter2 = "1";
-                  break;
-              case MULTISHOT_NIGHTLAPSE_MODE:
-                  // HERO7_BLACK and presumably above
-                  _parameter = "2";
-                  _parameter2 = "2";
-                  break;
-
-            default:
-                if (_debug)
-                {
-                    _debug_port->println("Wrong parameter for setMode");
-                }
-                return -1;
-            }
-
-            if ( _parameter2 == "" )
-            {
-                _request = "/gp/gpControl/command/mode?p=" + _parameter;
-            }
-            else
+            if (_debug)
             {
-                _request = "/gp/gpControl/command/sub_mode?mode=" + _parameter + "&sub_mode=" + _parameter2;
+                _debug_port->println("Scheduled shot cancelled: camera not reachable");
             }
+            _scheduled = false;
+            updateHealth(false);
+            return false;
         }
+        _preopened = true;
+        // connecting took time, take the remaining time again
+        _scheduled_at_us = micros() + (int32_t)(_scheduled_at - millis()) * 1000L;
+    }
 
-        return sendHTTPRequest(_request);
+    if (_preopened == false || remaining > SCHEDULE_SPIN)
+    {
+        return false;
     }
-    else // BLE
+
+    return fireSchedule();
+}
+
+void GoProControl::cancelSchedule()
+{
+    if (_scheduled == false)
     {
+        return;
+    }
 #if defined(ARDUINO_ARCH_ESP32)
-        switch (option)
-        {
-        case VIDEO_MODE:
-            sendBLERequest(BLE_ModeVideo);
-            break;
-        case PHOTO_MODE:
-            sendBLERequest(BLE_ModePhoto);
-            break;
-        case MULTISHOT_MODE:
-            sendBLERequest(BLE_ModeMultiShot);
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setMode");
-            }
-            return -1;
-        }
-#else
-        if (_debug)
+    if (_schedule_task != NULL && xTaskGetCurrentTaskHandle() != _schedule_task)
+    {
+        // the task may be using the connection: it cancels by itself, wait for it to end
+        _schedule_cancel = true;
+        xTaskNotifyGive(_schedule_task); // wake it up if it sleeps until the pre-open
+        while (_schedule_task != NULL)
         {
-            _debug_port->println("This shouldn't be run");
+            delay(1);
         }
-        return -1;
+        _schedule_cancel = false;
+        return;
+    }
 #endif
+    if (_preopened)
+    {
+        _transport->close();
+    }
+    _preopened = false;
+    _scheduled = false; // last, until here loop() must not touch the connection
+    if (_debug)
+    {
+        _debug_port->println("Scheduled shot cancelled");
     }
 }
 
-uint8_t GoProControl::setOrientation(const uint8_t option)
+bool GoProControl::isScheduled()
 {
-    if (!checkConnection()) // not connected
+    return _scheduled;
+}
+
+int32_t GoProControl::lastScheduleError()
+{
+    return _schedule_error;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void GoProControl::scheduleTask(void *parameter)
+{
+    GoProControl *gp = (GoProControl *)parameter;
+
+    while (gp->_scheduled)
+    {
+        if (gp->_schedule_cancel)
+        {
+            gp->cancelSchedule();
+            break;
+        }
+
+        const int32_t remaining = (int32_t)(gp->_scheduled_at - millis());
+        if (remaining > SCHEDULE_PREOPEN + 10)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(remaining - SCHEDULE_PREOPEN - 10)); // or cancelSchedule()
+        }
+        else if (remaining > SCHEDULE_SPIN + 1 && gp->_preopened)
+        {
+            vTaskDelay(1);
+        }
+        else
+        {
+            gp->handleSchedule();
+            if (gp->_preopened == false)
+            {
+                vTaskDelay(1); // not open yet: don't starve the core at the highest priority
+            }
+        }
+    }
+
+    // scheduleShoot() doesn't start another task while this handle is set, so it is still ours
+    gp->_schedule_task = NULL;
+    vTaskDelete(NULL);
+}
+#endif
+
+////////////////////////////////////////////////////////////
+////////                  Trigger                   ////////
+////////////////////////////////////////////////////////////
+
+// the interrupt can't take an argument on every board: one function per slot
+GoProControl *GoProControl::_trigger_cameras[TRIGGER_SLOTS] = {NULL};
+
+template <uint8_t SLOT>
+void IRAM_ATTR GoProControl::triggerIsr()
+{
+    if (_trigger_cameras[SLOT] != NULL)
+    {
+        _trigger_cameras[SLOT]->onTrigger();
+    }
+}
+
+static_assert(TRIGGER_SLOTS >= 1 && TRIGGER_SLOTS <= 8, "TRIGGER_SLOTS must be between 1 and 8");
+
+void (*const GoProControl::_trigger_isrs[TRIGGER_SLOTS])() = {
+    GoProControl::triggerIsr<0>,
+#if TRIGGER_SLOTS > 1
+    GoProControl::triggerIsr<1>,
+#endif
+#if TRIGGER_SLOTS > 2
+    GoProControl::triggerIsr<2>,
+#endif
+#if TRIGGER_SLOTS > 3
+    GoProControl::triggerIsr<3>,
+#endif
+#if TRIGGER_SLOTS > 4
+    GoProControl::triggerIsr<4>,
+#endif
+#if TRIGGER_SLOTS > 5
+    GoProControl::triggerIsr<5>,
+#endif
+#if TRIGGER_SLOTS > 6
+    GoProControl::triggerIsr<6>,
+#endif
+#if TRIGGER_SLOTS > 7
+    GoProControl::triggerIsr<7>,
+#endif
+};
+
+// Shoot on an edge of pin (RISING, FALLING or CHANGE, set pinMode() first): the shutter request
+// is serialized and the connection opened now, the interrupt only takes the time and raises a
+// flag, the request is written by a task on ESP32, by handleTrigger() in loop() on the other boards
+uint8_t GoProControl::armTrigger(const uint8_t pin, const uint8_t edge)
+{
+    if (_scheduled || _trigger_armed)
     {
         if (_debug)
         {
-            _debug_port->println("Connect the camera first");
+            _debug_port->println("A shot is already scheduled or armed");
         }
         return false;
     }
 
-    if (_camera == HERO3)
+    uint8_t slot = 0;
+    while (slot < TRIGGER_SLOTS && _trigger_cameras[slot] != NULL)
     {
-        switch (option)
+        slot++;
+    }
+    if (slot == TRIGGER_SLOTS)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Too many triggers, see TRIGGER_SLOTS");
+        }
+        return false;
+    }
+
+    if (!useBLE())
+    {
+        if (!checkConnection()) // not connected
         {
-        case ORIENTATION_UP:
-            _parameter = "00";
-            break;
-        case ORIENTATION_DOWN:
-            _parameter = "01";
-            break;
-        default:
             if (_debug)
             {
-                _debug_port->println("Wrong parameter for setOrientation");
+                _debug_port->println("Connect the camera first");
             }
-            return -1;
+            return false;
         }
+        if (!prepareShutter() || !connectClient(_policies[SHUTTER_COMMAND].connect_timeout))
+        {
+            return false;
+        }
+    }
+
+    _trigger_pin = pin;
+    _trigger_slot = slot;
+    _triggered = false;
+    _trigger_checked_at = millis();
+    _trigger_armed = true;
+    _trigger_cameras[slot] = this;
+    attachInterrupt(digitalPinToInterrupt(pin), _trigger_isrs[slot], edge);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    if (xTaskCreate(triggerTask, "gopro_trigger", 4096, this, configMAX_PRIORITIES - 1, &_trigger_task) != pdPASS)
+    {
+        _trigger_task = NULL;
+        if (_debug)
+        {
+            _debug_port->println("Unable to start the task, call handleTrigger() in loop()");
+        }
+    }
+#endif
+    return true;
+}
+
+void GoProControl::disarmTrigger()
+{
+    if (_trigger_armed == false)
+    {
+        return;
+    }
+    detachInterrupt(digitalPinToInterrupt(_trigger_pin));
+    _trigger_armed = false;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_trigger_task != NULL && xTaskGetCurrentTaskHandle() != _trigger_task)
+    {
+        // the task may be writing the shot: wake it and wait for it to end before closing
+        xTaskNotifyGive(_trigger_task);
+        while (_trigger_task != NULL)
+        {
+            delay(1);
+        }
+    }
+#endif
+    _trigger_cameras[_trigger_slot] = NULL;
+    _transport->close();
+}
+
+bool GoProControl::isArmed()
+{
+    return _trigger_armed;
+}
+
+uint8_t GoProControl::handleTrigger()
+{
+    if (_trigger_armed == false)
+    {
+        return false;
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_trigger_task != NULL && xTaskGetCurrentTaskHandle() != _trigger_task)
+    {
+        return false; // the task takes care of it
+    }
+#endif
+
+    if (_triggered)
+    {
+        return fireTrigger();
+    }
+
+    // keep the connection warm, the camera may have closed it
+    if (!useBLE() && millis() - _trigger_checked_at >= TRIGGER_CHECK)
+    {
+        _trigger_checked_at = millis();
+        if (!_transport->connected())
+        {
+            connectClient(_policies[SHUTTER_COMMAND].connect_timeout);
+        }
+    }
+    return false;
+}
+
+uint32_t GoProControl::lastTriggerLatency()
+{
+    return _trigger_latency;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void GoProControl::triggerTask(void *parameter)
+{
+    GoProControl *gp = (GoProControl *)parameter;
+
+    while (gp->_trigger_armed)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TRIGGER_CHECK)); // woken by the interrupt
+        gp->handleTrigger();
+    }
+
+    gp->_trigger_task = NULL;
+    vTaskDelete(NULL);
+}
+#endif
+#endif // GOPRO_SCHEDULE
+
+////////////////////////////////////////////////////////////
+////////                    Tags                    ////////
+////////////////////////////////////////////////////////////
+
+#if defined(GOPRO_TAGS)
+uint8_t GoProControl::tagMoment()
+{
+    return sendTag(micros());
+}
+
+// the free running uint8_t indexes wrap correctly only on a power of two
+static_assert(TAG_QUEUE_SIZE <= 128 && (TAG_QUEUE_SIZE & (TAG_QUEUE_SIZE - 1)) == 0, "TAG_QUEUE_SIZE must be a power of two up to 128");
+
+// from the interrupt of the button: only the time of the tap, handleTags() sends it. There must be
+// a single caller, _tag_head isn't locked: from loop() call tagMoment()
+uint8_t IRAM_ATTR GoProControl::queueTag()
+{
+    if ((uint8_t)(_tag_head - _tag_tail) >= TAG_QUEUE_SIZE) // full, this tap is lost
+    {
+        return false;
+    }
+    _tag_queue[_tag_head % TAG_QUEUE_SIZE] = micros();
+    _tag_head++;
+    return true;
+}
 
-        _request = "camera/UP?t=" + _pwd + "&p=%" + _parameter;
+uint8_t GoProControl::handleTags()
+{
+    while (_tag_tail != _tag_head)
+    {
+        const uint8_t result = sendTag(_tag_queue[_tag_tail % TAG_QUEUE_SIZE]);
+        if (result == false) // not sent or no answer: keep it for the next call, a double tag is better than a lost one
+        {
+            return false;
+        }
+        _tag_tail++;
+        if (result != true) // refused by the camera, it won't change if we ask again
+        {
+            return -1;
+        }
     }
-    else if (_camera >= HERO4)
+    return true;
+}
+
+uint8_t GoProControl::tagsPending()
+{
+    return _tag_head - _tag_tail;
+}
+
+uint32_t GoProControl::lastTagLatency()
+{
+    return _tag_latency;
+}
+#endif // GOPRO_TAGS
+
+////////////////////////////////////////////////////////////
+////////                  Settings                  ////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::setMode(const uint8_t option)
+{
+    if (useBLE())
     {
         switch (option)
         {
-        case ORIENTATION_UP:
-            _parameter = "0";
-            break;
-        case ORIENTATION_DOWN:
-            _parameter = "1";
-            break;
-        case ORIENTATION_AUTO:
-            _parameter = "2";
-            break;
+        case VIDEO_MODE:
+            return sendBLERequest(BLE_ModeVideo, LEN(BLE_ModeVideo), SETTING_COMMAND);
+        case PHOTO_MODE:
+            return sendBLERequest(BLE_ModePhoto, LEN(BLE_ModePhoto), SETTING_COMMAND);
+        case MULTISHOT_MODE:
+            return sendBLERequest(BLE_ModeMultiShot, LEN(BLE_ModeMultiShot), SETTING_COMMAND);
         default:
-            if (_debug)
+            if (!_power_saving) // otherwise the WiFi is turned on for it
             {
-                _debug_port->println("Wrong parameter for setOrientation");
+                if (_debug)
+                {
+                    _debug_port->println("Wrong parameter for setMode");
+                }
+                return -1;
             }
-            return -1;
         }
-
-        _request = "/gp/gpControl/setting/52/" + _parameter;
     }
 
-    return sendHTTPRequest(_request);
+    return sendSetting(SET_MODE, option, "setMode");
+}
+
+uint8_t GoProControl::setOrientation(const uint8_t option)
+{
+    return sendSetting(SET_ORIENTATION, option, "setOrientation");
 }
 
 ////////////////////////////////////////////////////////////
@@ -660,6 +1540,51 @@ uint8_t GoProControl::setOrientation(const uint8_t option)
 ////////////////////////////////////////////////////////////
 
 uint8_t GoProControl::setVideoResolution(const uint8_t option)
+{
+    const uint8_t result = sendSetting(SET_VIDEO_RESOLUTION, option, "setVideoResolution");
+    if (result == true)
+    {
+        _video_resolution = option;
+    }
+    return result;
+}
+
+uint8_t GoProControl::setVideoFov(const uint8_t option)
+{
+    return sendSetting(SET_VIDEO_FOV, option, "setVideoFov");
+}
+
+uint8_t GoProControl::setFrameRate(const uint8_t option)
+{
+    // the camera answers with an error after a round trip, don't even send it
+    if (_video_resolution != 0 && _capabilities.supports(SET_FRAME_RATE, option) &&
+        !_capabilities.supportsFrameRate(_video_resolution, option))
+    {
+        if (_debug)
+        {
+            _debug_port->println("Frame rate not available at this resolution");
+        }
+        return -1;
+    }
+
+    return sendSetting(SET_FRAME_RATE, option, "setFrameRate");
+}
+
+uint8_t GoProControl::setVideoEncoding(const uint8_t option)
+{
+    return sendSetting(SET_VIDEO_ENCODING, option, "setVideoEncoding");
+}
+
+////////////////////////////////////////////////////////////
+////////                   Photo                   /////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::setPhotoResolution(const uint8_t option)
+{
+    return sendSetting(SET_PHOTO_RESOLUTION, option, "setPhotoResolution");
+}
+
+uint8_t GoProControl::setTimeLapseInterval(float option)
 {
     if (!checkConnection()) // not connected
     {
@@ -670,81 +1595,1077 @@ uint8_t GoProControl::setVideoResolution(const uint8_t option)
         return false;
     }
 
-    if (_camera == HERO3)
+    // the camera knows 0.5 and whole seconds, 0.5 is option 0: the dialect tables tell which ones
+    if (option != 0.5 && (option < 1 || option > 255 || option != (uint8_t)option))
     {
-        switch (option)
+        if (_debug)
         {
-        case VR_1080p:
-            _parameter = "06";
-            break;
-        case VR_960p:
-            _parameter = "05";
-            break;
-        case VR_720p:
-            _parameter = "03";
-            break;
-        case VR_WVGA:
-            _parameter = "01";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setVideoResolution");
-            }
-            return -1;
+            _debug_port->println("Wrong parameter for setTimeLapseInterval");
         }
-
-        _request = "camera/VR?t=" + _pwd + "&p=%" + _parameter;
+        return -1;
     }
-    else if (_camera >= HERO4)
+    const uint8_t i_option = (option == 0.5) ? 0 : (uint8_t)option;
+
+    return sendSetting(SET_TIME_LAPSE_INTERVAL, i_option, "setTimeLapseInterval");
+}
+
+uint8_t GoProControl::setContinuousShot(const uint8_t option)
+{
+    return sendSetting(SET_CONTINUOUS_SHOT, option, "setContinuousShot");
+}
+
+////////////////////////////////////////////////////////////
+////////                   Others                   ////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::localizationOn()
+{
+    if (!checkConnection()) // not connected
     {
-        switch (option)
+        if (_debug)
         {
-        case VR_4K:
-            _parameter = "1";
-            break;
-        case VR_2K:
-            _parameter = "4";
-            break;
-        case VR_2K_SuperView:
-            _parameter = "5";
-            break;
-        case VR_1440p:
-            _parameter = "7";
-            break;
-        case VR_1080p_SuperView:
-            _parameter = "8";
-            break;
-        case VR_1080p:
-            _parameter = "9";
-            break;
-        case VR_960p:
-            _parameter = "10";
-            break;
-        case VR_720p_SuperView:
-            _parameter = "11";
-            break;
-        case VR_720p:
-            _parameter = "12";
-            break;
-        case VR_WVGA:
-            _parameter = "13";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setVideoResolution");
-            }
-            return -1;
+            _debug_port->println("Connect the camera first");
         }
+        return false;
+    }
+
+    return sendCommand(CMD_LOCATE_ON, SETTING_COMMAND);
+}
+
+uint8_t GoProControl::localizationOff()
+{
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    return sendCommand(CMD_LOCATE_OFF, SETTING_COMMAND);
+}
+
+uint8_t GoProControl::deleteLast()
+{
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    return sendCommand(CMD_DELETE_LAST, CONTROL_COMMAND);
+}
+
+uint8_t GoProControl::deleteAll()
+{
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    return sendCommand(CMD_DELETE_ALL, CONTROL_COMMAND);
+}
+
+////////////////////////////////////////////////////////////
+////////                Capabilities                ////////
+////////////////////////////////////////////////////////////
+
+bool GoProControl::isSupported(const uint8_t setting, const uint8_t option)
+{
+    return _capabilities.supports(setting, option);
+}
+
+uint8_t GoProControl::supportedOptions(const uint8_t setting, uint8_t options[], const uint8_t size)
+{
+    return _capabilities.list(setting, options, size);
+}
+
+#if defined(GOPRO_CAMERA_INFO)
+uint8_t GoProControl::readCameraInfo()
+{
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    if (HERO3_DIALECT)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Not supported by HERO3");
+        }
+        return false;
+    }
+
+    const StatusField fields[] = {{"info", "model_name"}, {"info", "firmware_version"}};
+    char values[2][STATUS_VALUE_SIZE];
+    StatusParser parser(fields, 2, values);
+
+    if (sendCommand(CMD_INFO, STATUS_COMMAND, &parser) != true || !parser.found(0) || !parser.found(1))
+    {
+        return false;
+    }
+
+    strcpy(_model_name, values[0]);
+    strcpy(_firmware, values[1]);
+    if (_debug)
+    {
+        _debug_port->print("Model: ");
+        _debug_port->print(_model_name);
+        _debug_port->print(" firmware: ");
+        _debug_port->println(_firmware);
+    }
+    return true;
+}
+
+const char *GoProControl::getModelName()
+{
+    return _model_name;
+}
+
+const char *GoProControl::getFirmware()
+{
+    return _firmware;
+}
+#endif
+
+////////////////////////////////////////////////////////////
+////////                   Clock                   /////////
+////////////////////////////////////////////////////////////
+
+uint8_t GoProControl::syncClock(const uint32_t unix_time, const uint16_t milliseconds)
+{
+    const uint32_t called_at = millis();
+
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    if (_round_trip == 0)
+    {
+        // no latency measured yet: a first rough set measures it
+        if (sendDateTime(unix_time + (milliseconds + millis() - called_at) / 1000) != true)
+        {
+            return false;
+        }
+    }
+
+    // the camera takes whole seconds: send so that the request arrives on a second boundary
+    const uint32_t latency = _connect_time + _round_trip / 2;
+    const uint64_t reference = (uint64_t)unix_time * 1000 + milliseconds;
+    const uint64_t now = reference + (millis() - called_at);
+    const uint64_t arrival = ((now + latency + 20) / 1000 + 1) * 1000; // 20 ms to build the request
+    const uint32_t send_at = called_at + (uint32_t)(arrival - latency - reference);
+
+    while ((int32_t)(send_at - millis()) > 0)
+    {
+        delay(1);
+    }
+
+    if (sendDateTime(arrival / 1000) != true)
+    {
+        return false;
+    }
+
+    _clock_set_time = arrival / 1000;
+    _clock_set_at = send_at + latency;
+
+    if (_debug)
+    {
+        _debug_port->print("Camera clock set, one way latency: ");
+        _debug_port->print(latency);
+        _debug_port->println(" ms");
+    }
+    return true;
+}
+
+uint8_t GoProControl::getCameraTime(uint32_t &unix_time)
+{
+    if (!checkConnection()) // not connected
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connect the camera first");
+        }
+        return false;
+    }
+
+    if (HERO3_DIALECT)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Not supported by HERO3");
+        }
+        return false;
+    }
+
+    // status 40 is the date as URL encoded bytes: %YY%MM%DD%HH%MM%SS
+    const StatusField fields[] = {{"status", "40"}};
+    char values[1][STATUS_VALUE_SIZE];
+    StatusParser parser(fields, 1, values);
+
+    if (sendCommand(CMD_STATUS, STATUS_COMMAND, &parser) != true || !parser.found(0))
+    {
+        return false;
+    }
+
+    uint8_t date[6];
+    uint8_t count = 0;
+    char *token = strtok(values[0], "%");
+    while (token != NULL && count < 6)
+    {
+        date[count++] = strtol(token, NULL, 16);
+        token = strtok(NULL, "%");
+    }
+    if (count < 6)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Wrong date from the camera");
+        }
+        return false;
+    }
+
+    unix_time = (uint32_t)daysFromCivil(2000 + date[0], date[1], date[2]) * 86400UL + date[3] * 3600UL + date[4] * 60UL + date[5];
+    return true;
+}
+
+uint8_t GoProControl::getClockDrift(int32_t &drift, float &ppm)
+{
+    if (_clock_set_time == 0)
+    {
+        if (_debug)
+        {
+            _debug_port->println("First run syncClock()");
+        }
+        return false;
+    }
+
+    uint32_t camera_time;
+    if (!getCameraTime(camera_time))
+    {
+        return false;
+    }
+
+    // the camera wrote its status about half round trip before the first byte arrived,
+    // its clock truncates to the second so we take the middle of that second
+    const uint32_t read_at = _first_byte_at - _round_trip / 2;
+    const uint32_t elapsed = read_at - _clock_set_at;
+    const int64_t expected = (int64_t)_clock_set_time * 1000 + elapsed;
+    drift = (int32_t)((int64_t)camera_time * 1000 + 500 - expected);
+    ppm = (elapsed > 0) ? (float)drift * 1000000.0 / elapsed : 0;
+
+    if (_debug)
+    {
+        _debug_port->print("Camera clock drift: ");
+        _debug_port->print(drift);
+        _debug_port->print(" ms, ");
+        _debug_port->print(ppm);
+        _debug_port->println(" ppm");
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+////////             Timeouts and retries          /////////
+////////////////////////////////////////////////////////////
+
+void GoProControl::setPolicy(const uint8_t command_class, const RequestPolicy policy)
+{
+    if (command_class >= command_class_last)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Wrong parameter for setPolicy");
+        }
+        return;
+    }
+    _policies[command_class] = policy;
+}
+
+RequestPolicy GoProControl::getPolicy(const uint8_t command_class)
+{
+    if (command_class >= command_class_last)
+    {
+        return DEFAULT_POLICIES[SETTING_COMMAND];
+    }
+    return _policies[command_class];
+}
+
+uint16_t GoProControl::lastRoundTrip()
+{
+    return _round_trip;
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+
+////////////////////////////////////////////////////////////
+////////               Asynchronous                /////////
+////////////////////////////////////////////////////////////
+
+// These return at once: true if the request is on its way, then the callback gets
+// true (200), -1 (the camera refused it) or false (no answer). One attempt only: the
+// retries of the policy need to wait and the callbacks run where waiting is not allowed
+
+uint8_t GoProControl::commandAsync(const uint8_t command, CommandCallback callback)
+{
+    if (command >= command_type_last ||
+        DIALECT(buildCommand(_request, LEN(_request), command, _auth, _auth_length)) == 0)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Command not supported by this camera");
+        }
+        return false;
+    }
+
+    return startAsync(commandClass(command), callback);
+}
+
+uint8_t GoProControl::settingAsync(const uint8_t setting, const uint8_t option, CommandCallback callback)
+{
+    if (!DIALECT(supports(setting)) || !_capabilities.supports(setting, option) ||
+        DIALECT(buildSetting(_request, LEN(_request), setting, option, _auth, _auth_length)) == 0)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Setting not supported by this camera");
+        }
+        return -1;
+    }
+    if (setting == SET_VIDEO_RESOLUTION)
+    {
+        _video_resolution = option;
+    }
+    return startAsync(SETTING_COMMAND, callback);
+}
+
+bool GoProControl::isBusy()
+{
+    return _async_busy;
+}
+
+uint8_t GoProControl::startAsync(const uint8_t command_class, CommandCallback callback)
+{
+    if (_async_busy || _scheduled || _trigger_armed || !checkConnection(true))
+    {
+        if (_debug)
+        {
+            _debug_port->println("Camera not connected or busy, command refused");
+        }
+        return false;
+    }
+
+    _async_length = buildHTTPRequest(_request, _async_request, LEN(_async_request));
+    if (_async_length == 0)
+    {
+        return false;
+    }
+
+    if (_debug)
+    {
+        _debug_port->print("HTTP request: ");
+        _debug_port->println(_request);
+    }
+
+    _response.reset();
+    _async_callback = callback;
+    _async_busy = true;
+    if (!_async_transport.connectAsync(_host, _wifi_port, _policies[command_class].deadline, asyncEvent, this))
+    {
+        _async_busy = false;
+        updateHealth(false);
+        return false;
+    }
+    return true;
+}
+
+void GoProControl::finishAsync(const uint16_t code)
+{
+    if (!_async_busy)
+    {
+        return;
+    }
+    _async_transport.close();
+    updateHealth(code != 0);
+    _last_request = millis();
+    _async_busy = false;
+
+    if (_async_callback != NULL)
+    {
+        _async_callback(this, code == 200 ? true : (code == 0 ? false : -1));
+    }
+}
+
+// runs in the AsyncTCP task
+void GoProControl::asyncEvent(void *arg, const uint8_t event, const uint8_t *data, const size_t size)
+{
+    GoProControl *gp = (GoProControl *)arg;
+
+    if (event == TRANSPORT_CONNECTED)
+    {
+        gp->_async_sent_at = millis();
+        if (gp->_async_transport.write((const uint8_t *)gp->_async_request, gp->_async_length) != gp->_async_length)
+        {
+            gp->finishAsync(0);
+        }
+    }
+    else if (event == TRANSPORT_DATA)
+    {
+        if (gp->_response.code() == 0 && !gp->_response.waitingLine()) // first bytes of the answer
+        {
+            gp->_round_trip = millis() - gp->_async_sent_at;
+        }
+        for (size_t i = 0; i < size; i++)
+        {
+            if (gp->_response.feed(data[i]))
+            {
+                gp->finishAsync(gp->_response.code());
+                return;
+            }
+        }
+    }
+    else // TRANSPORT_CLOSED
+    {
+        gp->finishAsync(gp->_response.code());
+    }
+}
+
+#endif
+
+////////////////////////////////////////////////////////////
+////////                Camera group                ////////
+////////////////////////////////////////////////////////////
+
+enum group_slot_state
+{
+    SLOT_IDLE = 0, // not asked: busy, not connected or command not supported
+    SLOT_CONNECTING,
+    SLOT_WAITING,
+    SLOT_DONE
+};
+
+static_assert(LEN(STATUS_FIELDS) == STATUS_FIELD_COUNT, "STATUS_FIELD_COUNT must match STATUS_FIELDS");
+
+GroupSlot::GroupSlot() : parser(STATUS_FIELDS, LEN(STATUS_FIELDS), values), state(SLOT_IDLE), code(0), sent_at(0), first_byte_at(0)
+{
+}
+
+#if defined(__linux__)
+// when every transport has a socket the group sleeps in epoll_wait() until one of them can go on,
+// otherwise it looks at them every ms
+static void groupWatch(int &epoll, Transport *transport, const uint8_t slot, const int operation, const uint32_t events)
+{
+    if (epoll < 0)
+    {
+        return;
+    }
+
+    epoll_event event;
+    event.events = events;
+    event.data.u32 = slot;
+    const int descriptor = transport->descriptor();
+    if ((descriptor < 0 || epoll_ctl(epoll, operation, descriptor, &event) < 0) && operation != EPOLL_CTL_DEL)
+    {
+        ::close(epoll);
+        epoll = -1;
+    }
+}
+#endif
+
+// All the requests leave before the first answer is read, then the answers are read as they
+// come: the snapshot takes as long as the slowest camera, not the sum. The cameras are asked
+// slot_count at a time, slots is the memory of their answers. Returns how many cameras
+// answered 200, 0 without slots; snapshot[i] is the status of cameras[i]
+uint8_t GoProControl::pollAllStatus(GoProControl *cameras[], const uint8_t count, CameraStatus snapshot[], GroupSlot slots[], const uint8_t slot_count, const uint16_t timeout)
+{
+    if (slot_count == 0 || slots == NULL) // nothing to ask them with
+    {
+        return 0;
+    }
+
+    uint8_t answered = 0;
+    for (uint16_t first = 0; first < count; first += slot_count)
+    {
+        const uint8_t size = min(count - first, (int)slot_count);
+        answered += runGroup(cameras + first, size, CMD_STATUS, slots, timeout);
+        for (uint8_t i = 0; i < size; i++)
+        {
+            CameraStatus &status = snapshot[first + i];
+            status.code = slots[i].code;
+            status.round_trip = (slots[i].code != 0) ? slots[i].first_byte_at - slots[i].sent_at : 0;
+            status.recording = -1;
+            status.mode = -1;
+            status.battery = -1;
+            status.video_left = -1;
+            if (slots[i].code == 200)
+            {
+                decodeStatus(slots[i].parser, slots[i].values, status);
+                cameras[first + i]->updateStatus(status);
+            }
+        }
+    }
+    return answered;
+}
+
+// The same for a command without options: results[i] is true, false or -1 like the command
+// of cameras[i] alone would return, one attempt only. Returns how many cameras accepted it
+uint8_t GoProControl::commandAll(GoProControl *cameras[], const uint8_t count, const uint8_t command, uint8_t results[], GroupSlot slots[], const uint8_t slot_count, const uint16_t timeout)
+{
+    if (slot_count == 0 || slots == NULL)
+    {
+        return 0;
+    }
+
+    uint8_t accepted = 0;
+    for (uint16_t first = 0; first < count; first += slot_count)
+    {
+        const uint8_t size = min(count - first, (int)slot_count);
+        accepted += runGroup(cameras + first, size, command, slots, timeout);
+        for (uint8_t i = 0; i < size; i++)
+        {
+            results[first + i] = (slots[i].code == 200) ? true : (slots[i].code == 0 ? false : -1);
+        }
+    }
+    return accepted;
+}
+
+uint8_t GoProControl::runGroup(GoProControl *cameras[], const uint8_t count, const uint8_t command, GroupSlot slots[], const uint16_t timeout)
+{
+    uint8_t chunk[32];
+    uint8_t waiting = 0;
+    const uint32_t start_time = millis();
+#if defined(__linux__)
+    int epoll = epoll_create1(0);
+#endif
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        slots[i].state = SLOT_IDLE;
+        slots[i].code = 0;
+        slots[i].first_byte_at = 0;
+
+        if (cameras[i]->startRequest(command))
+        {
+            slots[i].state = SLOT_CONNECTING;
+            waiting++;
+#if defined(__linux__)
+            groupWatch(epoll, cameras[i]->_transport, i, EPOLL_CTL_ADD, EPOLLOUT);
+#endif
+        }
+    }
+
+    while (waiting > 0 && millis() - start_time < timeout)
+    {
+        bool progress = false;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            GoProControl *camera = cameras[i];
+            GroupSlot &slot = slots[i];
+
+            if (slot.state == SLOT_CONNECTING)
+            {
+                const int8_t open = camera->_transport->finishConnect();
+                if (open == 0)
+                {
+                    continue;
+                }
+                progress = true;
+                camera->_response.reset(command == CMD_STATUS ? &slot.parser : NULL);
+                if (open < 0 || !camera->writeRequest())
+                {
+                    slot.state = SLOT_DONE;
+                    waiting--;
+#if defined(__linux__)
+                    groupWatch(epoll, camera->_transport, i, EPOLL_CTL_DEL, 0);
+#endif
+                    continue;
+                }
+                slot.sent_at = millis();
+                slot.state = SLOT_WAITING;
+#if defined(__linux__)
+                groupWatch(epoll, camera->_transport, i, EPOLL_CTL_MOD, EPOLLIN);
+#endif
+            }
+            else if (slot.state == SLOT_WAITING)
+            {
+                const int length = camera->_transport->read(chunk, LEN(chunk));
+                if (length == 0)
+                {
+                    continue;
+                }
+                progress = true;
+                if (slot.first_byte_at == 0)
+                {
+                    slot.first_byte_at = millis();
+                }
+                for (int j = 0; j < length && !camera->_response.completed(); j++)
+                {
+                    camera->_response.feed(chunk[j]);
+                }
+                if (length < 0 || camera->_response.completed())
+                {
+                    slot.state = SLOT_DONE;
+                    waiting--;
+#if defined(__linux__)
+                    groupWatch(epoll, camera->_transport, i, EPOLL_CTL_DEL, 0);
+#endif
+                }
+            }
+        }
+
+        if (!progress)
+        {
+#if defined(__linux__)
+            const int32_t left = timeout - (millis() - start_time);
+            if (epoll >= 0 && left > 0)
+            {
+                epoll_event events[16]; // only a wake up, every slot is looked at anyway
+                epoll_wait(epoll, events, LEN(events), left);
+                continue;
+            }
+#endif
+            delay(1);
+        }
+    }
+#if defined(__linux__)
+    if (epoll >= 0)
+    {
+        ::close(epoll);
+    }
+#endif
+
+    uint8_t answered = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        GoProControl *camera = cameras[i];
+        GroupSlot &slot = slots[i];
+        if (slot.state == SLOT_IDLE)
+        {
+            continue;
+        }
+
+        camera->_transport->close();
+        const uint16_t code = (slot.state == SLOT_CONNECTING) ? 0 : camera->_response.code();
+        camera->_last_request = millis();
+        camera->_wifi_used_at = millis();
+        camera->updateHealth(code != 0);
+        if (code == 0)
+        {
+            continue;
+        }
+
+        slot.code = code;
+        camera->_round_trip = slot.first_byte_at - slot.sent_at;
+        if (code == 200)
+        {
+            answered++;
+        }
+    }
+    return answered;
+}
+
+////////////////////////////////////////////////////////////
+////////                   Debug                   /////////
+////////////////////////////////////////////////////////////
+
+void GoProControl::enableDebug(UniversalSerial *debug_port, const uint32_t debug_baudrate)
+{
+    _debug = true;
+    _debug_port = debug_port;
+    _debug_port->begin(debug_baudrate);
+}
+
+void GoProControl::disableDebug(bool endSerial)
+{
+    if ( endSerial ) {
+        _debug_port->end();
+    }
+    _debug = false;
+}
+
+void GoProControl::printStatus()
+{
+    if (_debug)
+    {
+        _debug_port->print("\nSSID:\t\t");
+        _debug_port->println(WiFi.SSID());
+        _debug_port->print("Password:\t");
+        printCredential(_pwd);
+        _debug_port->print("Camera:\t\tHERO");
+        _debug_port->println(_camera);
+        _debug_port->print("IP Address:\t");
+        _debug_port->println(WiFi.localIP());
+        _debug_port->print("RSSI:\t\t");
+        _debug_port->print(WiFi.RSSI());
+        _debug_port->println(" dBm");
+
+        if (_connected == true)
+        {
+            if (macIsEmpty(_board_mac))
+            {
+                getBoardMac();
+            }
+            _debug_port->print("Board MAC:\t");
+            printMacAddress(_board_mac);
+
+            if (macIsEmpty(_gopro_mac))
+            {
+                getBSSID();
+            }
+
+            _debug_port->print("GoPro MAC:\t");
+            printMacAddress(_gopro_mac);
+            /*
+            _debug_port->print("Board Name:\t");
+            _debug_port->println(_board_name);
+            */
+        }
+        _debug_port->println();
+    }
+}
+
+////////////////////////////////////////////////////////////
+////////                  Private                  /////////
+////////////////////////////////////////////////////////////
+
+void GoProControl::sendWoL()
+{
+    // magic packet: 6 times 0xFF then 16 times the mac of the camera
+    uint8_t packet[WOL_PACKET_SIZE];
+    memset(packet, 0xFF, 6);
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        macCopy(packet + 6 + i * MAC_SIZE, _gopro_mac);
+    }
+
+    _transport->sendDatagram("255.255.255.255", _udp_port, packet, LEN(packet));
+}
+
+uint8_t GoProControl::sendRequest(const char *request)
+{
+    if (!connectClient(_policies[CONTROL_COMMAND].connect_timeout))
+    {
+        updateHealth(false);
+        return false;
+    }
+
+    if (_debug)
+    {
+        _debug_port->print("Request: ");
+        _debug_port->println(request);
+    }
+    _transport->write((const uint8_t *)request, strlen(request));
+    _transport->write((const uint8_t *)"\r\n", 2);
+    _transport->close();
+    updateHealth(true);
+    return true;
+}
+
+uint8_t GoProControl::sendHTTPRequest(const char *request, const uint8_t command_class, StatusParser *parser)
+{
+    const RequestPolicy policy = _policies[command_class];
+    const uint32_t start_time = millis();
+    uint16_t backoff = policy.backoff;
+    uint16_t response = 0;
+    bool reached = false;
+
+    if (_scheduled || _trigger_armed)
+    {
+        if (_debug)
+        {
+            _debug_port->println("A shot is scheduled or armed, command refused");
+        }
+        return false;
+    }
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+    if (_async_busy)
+    {
+        if (_debug)
+        {
+            _debug_port->println("An asynchronous command is running, command refused");
+        }
+        return false;
+    }
+#endif
+
+    char buffer[HTTP_REQUEST_SIZE];
+    const uint16_t length = buildHTTPRequest(request, buffer, LEN(buffer));
+    if (length == 0)
+    {
+        return false;
+    }
+
+    for (uint8_t attempt = 0; attempt <= policy.retries; attempt++)
+    {
+        if (attempt > 0)
+        {
+            uint32_t wait = backoff;
+            if (policy.jitter > 0)
+            {
+                wait += random((uint32_t)backoff * policy.jitter / 100 + 1);
+            }
+            if (millis() - start_time + wait >= policy.deadline)
+            {
+                break;
+            }
+            if (_debug)
+            {
+                _debug_port->print("Retrying in ");
+                _debug_port->print(wait);
+                _debug_port->println(" ms");
+            }
+            delay(wait);
+            // clamp before doubling, 2 * 32768 doesn't fit in the uint16_t
+            backoff = backoff >= policy.max_backoff / 2 ? policy.max_backoff : backoff * 2;
+        }
+
+        if (!connectClient(policy.connect_timeout))
+        {
+            continue; // nothing was written, always safe to try again
+        }
+        reached = true;
+
+        if (_debug)
+        {
+            _debug_port->print("HTTP request: ");
+            _debug_port->println(request);
+        }
+
+        if (parser != NULL)
+        {
+            parser->reset();
+        }
+        _parser = parser;
+
+        // one write: a single packet, and a single AT+CIPSEND on ESP01
+        const uint32_t sent_at = millis();
+        _transport->write((const uint8_t *)buffer, length);
+
+        response = listenResponse(policy.first_byte_timeout, start_time + policy.deadline);
+        _transport->close();
+        _parser = NULL;
+        if (response != 0)
+        {
+            _round_trip = _first_byte_at - sent_at;
+        }
+
+        // an answer, even a bad one, won't change if we ask again
+        // without an answer we don't know if the camera executed it: resend only if harmless
+        if (response != 0 || policy.idempotent == false)
+        {
+            break;
+        }
+    }
+
+    _wifi_used_at = millis();
+    if (reached == false)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Connection lost");
+        }
+        updateHealth(false);
+        return false;
+    }
+    updateHealth(response != 0);
+
+    if (response == 200)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Command: Accepted");
+        }
+        return true;
+    }
+    else if (response == 400)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Command: Bad request");
+        }
+    }
+    else if (response == 403)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Command: Wrong password");
+        }
+    }
+    else if (response == 410)
+    {
+        if (_debug)
+        {
+            _debug_port->println("Command: Failed");
+        }
+    }
+    else
+    {
+        if (_debug)
+        {
+            _debug_port->println("Command: Other error");
+        }
+    }
+    return -1;
+}
+
+uint8_t GoProControl::sendDateTime(const uint32_t unix_time)
+{
+    uint16_t year;
+    uint8_t month, day;
+    civilFromDays(unix_time / 86400, year, month, day);
+    const uint32_t seconds = unix_time % 86400;
+
+    // year since 2000, month, day, hour, minute, second, each one as a URL encoded byte
+    char date[19];
+    snprintf(date, LEN(date), "%%%02x%%%02x%%%02x%%%02x%%%02x%%%02x", (uint8_t)(year - 2000), month, day,
+             (uint8_t)(seconds / 3600), (uint8_t)(seconds / 60 % 60), (uint8_t)(seconds % 60));
+
+    if (HERO3_DIALECT)
+    {
+        snprintf(_request, LEN(_request), "/camera/TM%s&p=%s", _auth, date);
+    }
+    else
+    {
+        snprintf(_request, LEN(_request), "/gp/gpControl/command/setup/date_time?p=%s", date);
+    }
+
+    // a resent date would be late: CONTROL_COMMAND never resends
+    return sendHTTPRequest(_request, CONTROL_COMMAND);
+}
+
+uint8_t GoProControl::probeCamera()
+{
+#if !defined(GOPRO_HERO3_ONLY)
+    // HERO4 and newer: the model and the firmware from the JSON info, parsed while it arrives
+    const StatusField fields[] = {{"info", "model_name"}, {"info", "firmware_version"}};
+    char values[2][STATUS_VALUE_SIZE];
+    StatusParser parser(fields, 2, values);
+
+    if (GpControlDialect::buildCommand(_request, LEN(_request), CMD_INFO, NULL, 0) != 0 &&
+        sendHTTPRequest(_request, STATUS_COMMAND, &parser) == true && parser.found(0))
+    {
+#if defined(GOPRO_CAMERA_INFO)
+        strcpy(_model_name, values[0]);
+        strcpy(_firmware, parser.found(1) ? values[1] : "");
+#endif
+        _camera = cameraFromModel(values[0]);
+        return true;
+    }
+#endif
+
+#if !defined(GOPRO_GPCONTROL_ONLY)
+    // HERO3: no JSON, but the WiFi BacPac answers this one even with the camera off
+    if (sendHTTPRequest("/bacpac/sd", STATUS_COMMAND) == true)
+    {
+#if defined(GOPRO_CAMERA_INFO)
+        strcpy(_model_name, "HERO3");
+        _firmware[0] = '\0';
+#endif
+        _camera = HERO3;
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+bool GoProControl::loadDetectedCamera()
+{
+    DetectedCamera cache;
+    cache.magic = 0;
+    if (!_detect)
+    {
+        return false;
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    Preferences preferences;
+    preferences.begin("GoProControl", true);
+    preferences.getBytes("camera", &cache, sizeof(cache));
+    preferences.end();
+#elif defined(DETECT_CACHE_EEPROM)
+    bool opened;
+    if (beginEeprom(opened))
+    {
+        EEPROM.get(DETECT_EEPROM_ADDRESS, cache);
+    }
+    endEeprom(opened, false);
+#endif
 
-        _request = "/gp/gpControl/setting/2/" + _parameter;
+    char ssid[WIFI_SSID_SIZE];
+    readCredential(ssid, LEN(ssid), _ssid);
+    if (cache.magic != DETECT_MAGIC || cache.ssid_hash != hashString(ssid) ||
+        cache.camera < HERO3 || cache.camera > FUSION)
+    {
+        return false;
     }
 
-    return sendHTTPRequest(_request);
+    _camera = cache.camera;
+#if defined(GOPRO_CAMERA_INFO)
+    memcpy(_model_name, cache.model_name, STATUS_VALUE_SIZE);
+    memcpy(_firmware, cache.firmware, STATUS_VALUE_SIZE);
+    _model_name[STATUS_VALUE_SIZE - 1] = '\0';
+    _firmware[STATUS_VALUE_SIZE - 1] = '\0';
+#endif
+    return true;
 }
 
-uint8_t GoProControl::setVideoFov(const uint8_t option)
+void GoProControl::saveDetectedCamera()
+{
+    if (!_detect)
+    {
+        return;
+    }
+
+    DetectedCamera cache;
+    cache.magic = DETECT_MAGIC;
+    cache.camera = _camera;
+    char ssid[WIFI_SSID_SIZE];
+    readCredential(ssid, LEN(ssid), _ssid);
+    cache.ssid_hash = hashString(ssid);
+#if defined(GOPRO_CAMERA_INFO)
+    memcpy(cache.model_name, _model_name, STATUS_VALUE_SIZE);
+    memcpy(cache.firmware, _firmware, STATUS_VALUE_SIZE);
+#else
+    memset(cache.model_name, 0, STATUS_VALUE_SIZE); // the same layout with and without it
+    memset(cache.firmware, 0, STATUS_VALUE_SIZE);
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+    Preferences preferences;
+    preferences.begin("GoProControl", false);
+    preferences.putBytes("camera", &cache, sizeof(cache));
+    preferences.end();
+#elif defined(DETECT_CACHE_EEPROM)
+    bool opened;
+    const bool room = beginEeprom(opened);
+    if (room)
+    {
+        EEPROM.put(DETECT_EEPROM_ADDRESS, cache);
+    }
+    endEeprom(opened, room);
+#endif
+}
+
+uint8_t GoProControl::sendSetting(const uint8_t setting, const uint8_t option, const char *name)
 {
     if (!checkConnection()) // not connected
     {
@@ -755,747 +2676,706 @@ uint8_t GoProControl::setVideoFov(const uint8_t option)
         return false;
     }
 
-    if (_camera == HERO3)
+    if (!DIALECT(supports(setting)))
     {
-        switch (option)
+        if (_debug)
         {
-        case WIDE_FOV:
-            _parameter = "00";
-            break;
-        case MEDIUM_FOV:
-            _parameter = "01";
-            break;
-        case NARROW_FOV:
-            _parameter = "02";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setVideoFov");
-            }
-            return -1;
+            _debug_port->print("Not supported by this camera: ");
+            _debug_port->println(name);
         }
-
-        _request = "camera/FV?t=" + _pwd + "&p=%" + _parameter;
+        return false;
     }
-    else if (_camera >= HERO4)
+
+    if (!_capabilities.supports(setting, option) ||
+        DIALECT(buildSetting(_request, LEN(_request), setting, option, _auth, _auth_length)) == 0)
     {
-        switch (option)
+        if (_debug)
         {
-        case WIDE_FOV:
-            _parameter = "0";
-            break;
-        case MEDIUM_FOV:
-            _parameter = "1";
-            break;
-        case NARROW_FOV:
-            _parameter = "2";
-            break;
-        case LINEAR_FOV:
-            _parameter = "4";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setVideoFov");
-            }
-            return -1;
+            _debug_port->print("Wrong parameter for ");
+            _debug_port->println(name);
         }
-
-        _request = "/gp/gpControl/setting/4/" + _parameter;
+        return -1;
     }
 
-    return sendHTTPRequest(_request);
+    return sendHTTPRequest(_request, SETTING_COMMAND);
 }
 
-uint8_t GoProControl::setFrameRate(const uint8_t option)
+uint8_t GoProControl::sendCommand(const uint8_t command, const uint8_t command_class, StatusParser *parser)
 {
-    if (!checkConnection()) // not connected
+    if (DIALECT(buildCommand(_request, LEN(_request), command, _auth, _auth_length)) == 0)
     {
         if (_debug)
         {
-            _debug_port->println("Connect the camera first");
+            _debug_port->println("Command not supported by this camera");
         }
         return false;
     }
 
-    if (_camera == HERO3)
-    {
-        switch (option)
-        {
-        case FR_240:
-            _parameter = "0a";
-            break;
-        case FR_120:
-            _parameter = "09";
-            break;
-        case FR_100:
-            _parameter = "08";
-            break;
-        case FR_60:
-            _parameter = "07";
-            break;
-        case FR_50:
-            _parameter = "06";
-            break;
-        case FR_48:
-            _parameter = "05";
-            break;
-        case FR_30:
-            _parameter = "04";
-            break;
-        case FR_25:
-            _parameter = "03";
-            break;
-        case FR_24:
-            _parameter = "02";
-            break;
-        case FR_12p5:
-            _parameter = "0b";
-            break;
-        case FR_15:
-            _parameter = "01";
-            break;
-        case FR_12:
-            _parameter = "00";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setFrameRate");
-            }
-            return -1;
-        }
+    return sendHTTPRequest(_request, command_class, parser);
+}
 
-        _request = "camera/FS?t=" + _pwd + "&p=%" + _parameter;
+uint16_t GoProControl::buildHTTPRequest(const char *request, char buffer[], const uint16_t size)
+{
+    int length;
+    if (DIALECT(host_with_port))
+    {
+        length = snprintf(buffer, size, "GET %s HTTP/1.1\r\nHost: %s:%u\r\nConnection: Keep-Alive\r\n\r\n",
+                          request, _host, _wifi_port);
+    }
+    else
+    {
+        length = snprintf(buffer, size, "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: Keep-Alive\r\n\r\n",
+                          request, _host);
     }
-    else if (_camera >= HERO4)
+
+    if (length < 0 || length >= size)
     {
-        switch (option)
+        if (_debug)
         {
-        case FR_240:
-            _parameter = "0";
-            break;
-        case FR_120:
-            _parameter = "1";
-            break;
-        case FR_100:
-            _parameter = "2";
-            break;
-        case FR_90:
-            _parameter = "3";
-            break;
-        case FR_80:
-            _parameter = "4";
-            break;
-        case FR_60:
-            _parameter = "5";
-            break;
-        case FR_50:
-            _parameter = "6";
-            break;
-        case FR_48:
-            _parameter = "7";
-            break;
-        case FR_30:
-            _parameter = "8";
-            break;
-        case FR_25:
-            _parameter = "9";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setFrameRate");
-            }
-            return -1;
+            _debug_port->println("Request too long");
         }
-
-        _request = "/gp/gpControl/setting/3/" + _parameter;
+        return 0;
     }
-
-    return sendHTTPRequest(_request);
+    return length;
 }
 
-uint8_t GoProControl::setVideoEncoding(const uint8_t option)
+uint8_t GoProControl::confirmRecording(const bool recording, const uint16_t deadline)
 {
-    if (!checkConnection()) // not connected
+    if (HERO3_DIALECT || useBLE())
     {
         if (_debug)
         {
-            _debug_port->println("Connect the camera first");
+            _debug_port->println("Not supported by HERO3 and over BLE");
         }
         return false;
     }
 
-    if (_camera == HERO3)
+    const uint32_t start_time = millis();
+    const uint8_t result = recording ? shoot() : stopShoot();
+    if (result != true)
     {
-        switch (option)
-        {
-        case NTSC:
-            _parameter = "00";
-            break;
-        case PAL:
-            _parameter = "01";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setVideoEncoding");
-            }
-            return -1;
-        }
-
-        _request = "camera/VM?t=" + _pwd + "&p=%" + _parameter;
+        return result;
     }
-    else if (_camera >= HERO4)
+
+    // the camera got the command about half round trip after it was written
+    const uint32_t command_at = _first_byte_at - _round_trip / 2;
+    const uint16_t command_round_trip = _round_trip;
+
+    // status 8: recording or processing
+    const StatusField fields[] = {{"status", "8"}};
+    char values[1][STATUS_VALUE_SIZE];
+    StatusParser parser(fields, 1, values);
+
+    uint32_t previous_at = command_at; // the last time the camera showed the old state
+    uint16_t interval = CONFIRM_POLL_MIN;
+    while (millis() - start_time < deadline)
     {
-        switch (option)
+        if (sendCommand(CMD_STATUS, STATUS_COMMAND, &parser) == true && parser.found(0))
         {
-        case NTSC:
-            _parameter = "0";
-            break;
-        case PAL:
-            _parameter = "1";
-            break;
-        default:
-            if (_debug)
+            const uint32_t read_at = _first_byte_at - _round_trip / 2; // when the camera wrote the status
+            if ((atoi(values[0]) != 0) == recording)
             {
-                _debug_port->println("Wrong parameter for setVideoEncoding");
+                // it changed between the two reads, take the middle
+                _confirm_uncertainty = (read_at - previous_at) / 2;
+                _confirm_latency = previous_at + _confirm_uncertainty - command_at;
+                _round_trip = command_round_trip; // lastRoundTrip() is the one of the command
+
+                if (_debug)
+                {
+                    _debug_port->print(recording ? "Recording confirmed after " : "Stop confirmed after ");
+                    _debug_port->print(_confirm_latency);
+                    _debug_port->print(" +- ");
+                    _debug_port->print(_confirm_uncertainty);
+                    _debug_port->println(" ms");
+                }
+                return true;
             }
-            return -1;
+            previous_at = read_at;
         }
 
-        _request = "/gp/gpControl/setting/57/" + _parameter;
+        // start tight, the change usually comes within a few hundred ms, then slow down
+        delay(interval);
+        interval = min((uint16_t)(interval * 3 / 2 + 1), (uint16_t)CONFIRM_POLL_MAX);
     }
 
-    return sendHTTPRequest(_request);
+    _round_trip = command_round_trip;
+    if (_debug)
+    {
+        _debug_port->println(recording ? "Command accepted but the camera is not recording" : "Command accepted but the camera is still recording");
+    }
+    return -1;
 }
 
-////////////////////////////////////////////////////////////
-////////                   Photo                   /////////
-////////////////////////////////////////////////////////////
-
-uint8_t GoProControl::setPhotoResolution(const uint8_t option)
+#if defined(GOPRO_SCHEDULE)
+bool GoProControl::prepareShutter()
 {
-    if (!checkConnection()) // not connected
+    if (DIALECT(buildCommand(_request, LEN(_request), CMD_SHUTTER_ON, _auth, _auth_length)) == 0)
     {
-        if (_debug)
-        {
-            _debug_port->println("Connect the camera first");
-        }
         return false;
     }
+    _scheduled_length = buildHTTPRequest(_request, _scheduled_request, LEN(_scheduled_request));
+    return _scheduled_length != 0;
+}
+
+// in the interrupt: only the time and a flag
+void IRAM_ATTR GoProControl::onTrigger()
+{
+    const uint32_t now = micros();
+    if (_triggered || now - _trigger_at_us < TRIGGER_DEBOUNCE * 1000UL)
+    {
+        return;
+    }
+    _trigger_at_us = now;
+    _triggered = true;
 
-    if (_camera == HERO3)
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_trigger_task != NULL)
     {
-        switch (option)
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_trigger_task, &woken);
+        if (woken)
         {
-        case PR_11MP_WIDE:
-            _parameter = "00";
-            break;
-        case PR_8MP_WIDE:
-            _parameter = "01";
-            break;
-        case PR_5MP_WIDE:
-            _parameter = "02";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setPhotoResolution");
-            }
-            return -1;
+            portYIELD_FROM_ISR();
         }
+    }
+#endif
+}
 
-        _request = "camera/PR?t=" + _pwd + "&p=%" + _parameter;
+uint8_t GoProControl::fireTrigger()
+{
+    uint8_t result;
+    if (useBLE())
+    {
+        _trigger_latency = micros() - _trigger_at_us;
+        _triggered = false;
+        result = sendBLERequest(BLE_RecordStart, LEN(BLE_RecordStart), SHUTTER_COMMAND);
     }
-    else if (_camera >= HERO4)
+    else
     {
-        switch (option)
+        if (!_transport->connected() && !connectClient(_policies[SHUTTER_COMMAND].connect_timeout))
         {
-        case PR_12MP_WIDE:
-            _parameter = "0";
-            break;
-        case PR_12MP_LINEAR:
-            _parameter = "10";
-            break;
-        case PR_12MP_MEDIUM:
-            _parameter = "8";
-            break;
-        case PR_12MP_NARROW:
-            _parameter = "9";
-            break;
-        case PR_7MP_WIDE:
-            _parameter = "1";
-            break;
-        case PR_7MP_MEDIUM:
-            _parameter = "2";
-            break;
-        case PR_5MP_WIDE:
-            _parameter = "3";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setPhotoResolution");
-            }
-            return -1;
+            _triggered = false;
+            updateHealth(false);
+            return false;
         }
 
-        _request = "/gp/gpControl/setting/17/" + _parameter;
+        const uint32_t sent_at = micros();
+        _transport->write((const uint8_t *)_scheduled_request, _scheduled_length);
+        _trigger_latency = sent_at - _trigger_at_us;
+        _triggered = false; // edges from now on are the next shot
+
+        const RequestPolicy policy = _policies[SHUTTER_COMMAND];
+        const uint16_t response = listenResponse(policy.first_byte_timeout, millis() + policy.deadline);
+        _transport->close();
+        _last_request = millis();
+        updateHealth(response != 0);
+        result = (response == 200) ? true : (response == 0 ? false : -1);
+
+        // ready for the next edge
+        connectClient(policy.connect_timeout);
+        _trigger_checked_at = millis();
     }
 
-    return sendHTTPRequest(_request);
+    if (_debug)
+    {
+        _debug_port->print("Trigger fired, latency: ");
+        _debug_port->print(_trigger_latency);
+        _debug_port->println(" us");
+    }
+    return result;
 }
+#endif
 
-uint8_t GoProControl::setTimeLapseInterval(float option)
+#if defined(GOPRO_TAGS)
+uint8_t GoProControl::sendTag(const uint32_t tapped_at)
 {
-    if (!checkConnection()) // not connected
+    if (_scheduled || _trigger_armed)
     {
         if (_debug)
         {
-            _debug_port->println("Connect the camera first");
+            _debug_port->println("A shot is scheduled or armed, tag refused");
         }
         return false;
     }
-
-    // convert float to integer
-    if (option == 0.5)
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+    if (_async_busy)
     {
-        option = 0;
+        if (_debug)
+        {
+            _debug_port->println("An asynchronous command is running, tag refused");
+        }
+        return false;
     }
-    const uint8_t i_option = (uint8_t)option;
+#endif
 
-    if (i_option != 0 || i_option != 1 || i_option != 5 || i_option != 10 || i_option != 30 || i_option != 60)
+    if (!checkConnection(true))
     {
         if (_debug)
         {
-            _debug_port->println("Wrong parameter for setTimeLapseInterval");
+            _debug_port->println("Connect the camera first");
         }
-        return -1;
+        return false;
     }
 
-    if (_camera == HERO3)
+    // the request is the same for every tag: build it once, a tap is then a single write
+    if (_tag_length == 0 || _tag_camera != _camera)
     {
-        switch (i_option)
+        _tag_length = 0;
+        if (DIALECT(buildCommand(_request, LEN(_request), CMD_TAG_MOMENT, _auth, _auth_length)) == 0)
         {
-        case 60:
-            _parameter = "3c";
-            break;
-        case 30:
-            _parameter = "1e";
-            break;
-        case 10:
-            _parameter = "0a";
-            break;
-        case 5:
-            _parameter = "05";
-            break;
-        case 1:
-            _parameter = "01";
-            break;
-        case 0: // 0.5
-            _parameter = "00";
-            break;
-        default:
             if (_debug)
             {
-                _debug_port->println("Wrong parameter for setTimeLapseInterval");
+                _debug_port->println("Command not supported by this camera");
             }
-            return -1;
+            return false;
         }
-
-        _request = "camera/TI?t=" + _pwd + "&p=%" + _parameter;
-    }
-    else if (_camera >= HERO4)
-    {
-        switch (i_option)
+        _tag_length = buildHTTPRequest(_request, _tag_request, LEN(_tag_request));
+        if (_tag_length == 0)
         {
-        case 60:
-            _parameter = "6";
-            break;
-        case 30:
-            _parameter = "5";
-            break;
-        case 10:
-            _parameter = "4";
-            break;
-        case 5:
-            _parameter = "3";
-            break;
-        case 1:
-            _parameter = "1";
-            break;
-        case 0: // 0.5
-            _parameter = "0";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setTimeLapseInterval");
-            }
-            return -1;
+            return false;
         }
-
-        _request = "/gp/gpControl/setting/5/" + _parameter;
+        _tag_camera = _camera;
     }
 
-    return sendHTTPRequest(_request);
-}
-
-uint8_t GoProControl::setContinuousShot(const uint8_t option)
-{
-    if (!checkConnection()) // not connected
+    // the previous tag read its whole answer and left the connection open: use it again, unless the
+    // camera closed it or sent something we didn't ask for
+    const RequestPolicy policy = _policies[SHUTTER_COMMAND];
+    uint8_t rest[1];
+    if (!_transport->connected() || _transport->read(rest, LEN(rest)) != 0)
     {
-        if (_debug)
+        if (!connectClient(policy.connect_timeout)) // closes the old one first
         {
-            _debug_port->println("Connect the camera first");
+            updateHealth(false);
+            return false;
         }
+    }
+
+    const uint32_t sent_at = micros();
+    if (_transport->write((const uint8_t *)_tag_request, _tag_length) != _tag_length)
+    {
+        _transport->close();
+        updateHealth(false);
         return false;
     }
+    _tag_latency = sent_at - tapped_at;
+    const uint32_t written_at = millis();
 
-    // convert float to integer
-    const uint8_t i_option = (uint8_t)option;
+    const uint16_t response = listenResponse(policy.first_byte_timeout, written_at + policy.deadline, true);
+    if (response == 0 || !_response.reusable())
+    {
+        _transport->close(); // the end of the answer could still arrive, the next tag opens a new one
+    }
+    if (response != 0)
+    {
+        _round_trip = _first_byte_at - written_at;
+    }
+    _last_request = millis();
+    _wifi_used_at = millis();
+    updateHealth(response != 0);
 
-    if (i_option != 0 || i_option != 3 || i_option != 5 || i_option != 10)
+    if (_debug)
     {
-        if (_debug)
-        {
-            _debug_port->println("Wrong parameter for setContinuousShot");
-        }
-        return -1;
+        _debug_port->print("Tag latency: ");
+        _debug_port->print(_tag_latency);
+        _debug_port->println(" us");
     }
 
-    if (_camera == HERO3)
+    if (response == 200)
     {
-        switch (option)
-        {
-        case 10:
-            _parameter = "0a";
-            break;
-        case 5:
-            _parameter = "05";
-            break;
-        case 3:
-            _parameter = "03";
-            break;
-        case 0:
-            _parameter = "00";
-            break;
-        default:
-            if (_debug)
-            {
-                _debug_port->println("Wrong parameter for setContinuousShot");
-            }
-            return -1;
-        }
+        return true;
+    }
+    return response == 0 ? false : -1;
+}
+#endif
 
-        _request = "camera/CS?t=" + _pwd + "&p=%" + _parameter;
+bool GoProControl::startRequest(const uint8_t command)
+{
+    if (_scheduled || _trigger_armed || !checkConnection(true))
+    {
+        return false;
     }
-    else if (_camera >= HERO4)
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+    if (_async_busy)
     {
-        if (_debug)
-        {
-            _debug_port->println("Not supported by HERO4 and newer");
-        }
         return false;
     }
-    return sendHTTPRequest(_request);
-}
-
-////////////////////////////////////////////////////////////
-////////                   Others                   ////////
-////////////////////////////////////////////////////////////
+#endif
 
-uint8_t GoProControl::localizationOn()
-{
-    if (!checkConnection()) // not connected
+    if (command >= command_type_last ||
+        DIALECT(buildCommand(_request, LEN(_request), command, _auth, _auth_length)) == 0)
     {
         if (_debug)
         {
-            _debug_port->println("Connect the camera first");
+            _debug_port->println("Command not supported by this camera");
         }
         return false;
     }
-
-    if (_camera == HERO3)
-    {
-        _request = "camera/LL?t=" + _pwd + "&p=%01";
-    }
-    else if (_camera >= HERO4)
+    if (!_transport->startConnect(_host, _wifi_port, _policies[commandClass(command)].connect_timeout))
     {
-        _request = "/gp/gpControl/command/system/locate?p=1";
+        updateHealth(false);
+        return false;
     }
-
-    return sendHTTPRequest(_request);
+    return true;
 }
 
-uint8_t GoProControl::localizationOff()
+void GoProControl::updateStatus(const CameraStatus &status)
 {
-    if (!checkConnection()) // not connected
+    uint8_t changed = 0;
+    if (status.recording != _status.recording)
     {
-        if (_debug)
-        {
-            _debug_port->println("Connect the camera first");
-        }
-        return false;
+        changed |= STATUS_RECORDING;
     }
-
-    if (_camera == HERO3)
+    if (status.mode != _status.mode)
     {
-        _request = "camera/LL?t=" + _pwd + "&p=%00";
+        changed |= STATUS_MODE;
     }
-    else if (_camera >= HERO4)
+    if (status.battery != _status.battery)
     {
-        _request = "/gp/gpControl/command/system/locate?p=0";
+        changed |= STATUS_BATTERY;
     }
+    if (status.video_left != _status.video_left)
+    {
+        changed |= STATUS_VIDEO_LEFT;
+    }
+    _status = status;
 
-    return sendHTTPRequest(_request);
-}
-
-uint8_t GoProControl::deleteLast()
-{
-    if (!checkConnection()) // not connected
+#if defined(GOPRO_STATUS_EVENTS)
+    for (uint8_t i = 0; i < STATUS_SUBSCRIPTIONS && _status_subscriptions[i].callback != NULL; i++)
     {
-        if (_debug)
+        if (changed & _status_subscriptions[i].mask)
         {
-            _debug_port->println("Connect the camera first");
+            _status_subscriptions[i].callback(this, changed & _status_subscriptions[i].mask, _status);
         }
-        return false;
     }
+#else
+    (void)changed;
+#endif
+}
 
-    if (_camera == HERO3)
+bool GoProControl::writeRequest()
+{
+    char buffer[HTTP_REQUEST_SIZE];
+    const uint16_t length = buildHTTPRequest(_request, buffer, LEN(buffer));
+    if (length == 0)
     {
-        _request = "camera/DL?t=" + _pwd;
+        return false;
     }
-    else if (_camera >= HERO4)
+
+    if (_debug)
     {
-        _request = "/gp/gpControl/command/storage/delete/last";
+        _debug_port->print("HTTP request: ");
+        _debug_port->println(_request);
     }
-
-    return sendHTTPRequest(_request);
+    return _transport->write((const uint8_t *)buffer, length) == length;
 }
 
-uint8_t GoProControl::deleteAll()
+#if defined(GOPRO_SCHEDULE)
+uint8_t GoProControl::fireSchedule()
 {
-    if (!checkConnection()) // not connected
+    // spin the last instants, we are at most SCHEDULE_SPIN ms away
+    while ((int32_t)(micros() - _scheduled_at_us) < 0)
     {
-        if (_debug)
-        {
-            _debug_port->println("Connect the camera first");
-        }
-        return false;
     }
 
-    if (_camera == HERO3)
-    {
-        _request = "camera/DA?t=" + _pwd;
-    }
-    else if (_camera >= HERO4)
+    const uint32_t fired_at = micros();
+    _transport->write((const uint8_t *)_scheduled_request, _scheduled_length);
+    _schedule_error = (int32_t)(fired_at - _scheduled_at_us);
+
+    if (_debug)
     {
-        _request = "/gp/gpControl/command/command/storage/delete/all";
+        _debug_port->print("Scheduled shot fired, error: ");
+        _debug_port->print(_schedule_error);
+        _debug_port->println(" us");
     }
 
-    return sendHTTPRequest(_request);
-}
+    const RequestPolicy policy = _policies[SHUTTER_COMMAND];
+    const uint16_t response = listenResponse(policy.first_byte_timeout, millis() + policy.deadline);
+    _transport->close();
+    // only now loop() can use the connection again
+    _preopened = false;
+    _scheduled = false;
+    updateHealth(response != 0);
 
-////////////////////////////////////////////////////////////
-////////                   Debug                   /////////
-////////////////////////////////////////////////////////////
+    return response == 200;
+}
+#endif
 
-void GoProControl::enableDebug(UniversalSerial *debug_port, const uint32_t debug_baudrate)
+bool GoProControl::useBLE()
 {
-    _debug = true;
-    _debug_port = debug_port;
-    _debug_port->begin(debug_baudrate);
+#if defined(GOPRO_BLE_CONTROL)
+    return WIFI_MODE == false || (_power_saving && BLE_ENABLED);
+#else
+    return false;
+#endif
 }
 
-void GoProControl::disableDebug(bool endSerial)
+void GoProControl::accountRadio()
 {
-    if ( endSerial ) {
-        _debug_port->end();
+#if defined(GOPRO_BLE_CONTROL)
+    const uint32_t now = millis();
+    if (WIFI_MODE && _wanted)
+    {
+        _wifi_time += now - _radio_since;
     }
-    _debug = false;
+    if (BLE_ENABLED)
+    {
+        _ble_time += now - _radio_since;
+    }
+    _radio_since = now;
+#endif
 }
 
-void GoProControl::printStatus()
+uint8_t GoProControl::sendBLERequest(const uint8_t request[], const uint8_t size, const uint8_t command_class)
 {
-    if (_debug)
+#if !defined(GOPRO_BLE_CONTROL)
+    return false; // useBLE() is always false
+#else
+    if (BLE_ENABLED == false || _ble.link() == NULL || !_ble.link()->connected())
     {
-        _debug_port->print("\nSSID:\t\t");
-        _debug_port->println(WiFi.SSID());
-        _debug_port->print("Password:\t");
-        _debug_port->println(_pwd);
-        _debug_port->print("Camera:\t\tHERO");
-        _debug_port->println(_camera);
-        _debug_port->print("IP Address:\t");
-        _debug_port->println(WiFi.localIP());
-        _debug_port->print("RSSI:\t\t");
-        _debug_port->print(WiFi.RSSI());
-        _debug_port->println(" dBm");
-
-        if (_connected == true)
+        if (_debug)
         {
-            if (_board_mac[0] == 0)
-            {
-                WiFi.macAddress(_board_mac); //esp32 ok esp8266 s
-            }
-            _debug_port->print("Board MAC:\t");
-            printMacAddress(_board_mac);
-
-            if (_gopro_mac[0] == 0)
-            {
-                getBSSID();
-            }
+            _debug_port->println("BLE not connected, run enableBLE()");
+        }
+        return false;
+    }
 
-            _debug_port->print("GoPro MAC:\t");
-            printMacAddress(_gopro_mac);
-            /*
-            _debug_port->print("Board Name:\t");
-            _debug_port->println(_board_name);
-            */
+    if (_debug)
+    {
+        _debug_port->print("BLE request:");
+        for (uint8_t i = 0; i < size; i++)
+        {
+            _debug_port->print(" ");
+            _debug_port->print(request[i], HEX);
         }
         _debug_port->println();
     }
-}
 
-////////////////////////////////////////////////////////////
-////////                  Private                  /////////
-////////////////////////////////////////////////////////////
-
-void GoProControl::sendWoL()
-{
-    uint8_t preamble[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-    IPAddress addr(255, 255, 255, 255);
-
-    _udp_client.begin(_udp_port);
-    _udp_client.beginPacket(addr, _udp_port);
-
-    _udp_client.write(preamble, LEN(preamble));
-
-    for (uint8_t i = 0; i < 16; i++)
+    const uint32_t start_time = millis();
+    if (!_ble.request(request, size))
     {
-        _udp_client.write(_gopro_mac, LEN(_gopro_mac));
+        if (_debug)
+        {
+            _debug_port->println("BLE write failed");
+        }
+        return false;
     }
-    _udp_client.endPacket();
-    _udp_client.stop();
-}
 
-uint8_t GoProControl::sendRequest(const String request)
-{
-    if (!connectClient())
+    // the notification ends the wait, the timeout only if it never comes
+    while (_ble.pending() && millis() - start_time < _policies[command_class].first_byte_timeout)
     {
-        return false;
+        delay(1);
     }
+    _ble.cancel();
+    _round_trip = millis() - start_time;
 
+    const uint8_t result = _ble.result();
     if (_debug)
     {
-        _debug_port->println("Request: " + request);
+        if (result == true)
+        {
+            _debug_port->println("Command: Accepted");
+        }
+        else if (result == false)
+        {
+            _debug_port->println("Command: No answer");
+        }
+        else
+        {
+            _debug_port->print("Command: Refused with status ");
+            _debug_port->println(_ble.status());
+        }
     }
-    _wifi_client.println(request);
-    _wifi_client.stop();
+    return result;
+#endif
 }
 
-uint8_t GoProControl::sendHTTPRequest(const String request)
+// WiFi.begin() wants the credentials in RAM: from flash they are copied only for the call
+void GoProControl::startWiFi()
 {
-    if (!connectClient())
+    if (_progmem_credentials)
     {
-        return false;
+        char ssid[WIFI_SSID_SIZE];
+        char pwd[WIFI_PASSWORD_SIZE];
+        readCredential(ssid, LEN(ssid), _ssid);
+        readCredential(pwd, LEN(pwd), _pwd);
+        WiFi.begin(ssid, pwd);
     }
-
-    if (_debug)
+    else
     {
-        _debug_port->println("HTTP request: " + request);
+        WiFi.begin(_ssid, _pwd);
     }
+}
 
-    _wifi_client.println("GET " + request + " HTTP/1.1");
-    if (_camera == HERO3)
+void GoProControl::readCredential(char buffer[], const uint8_t size, const char *text)
+{
+    if (_progmem_credentials)
     {
-        _wifi_client.println("Host: " + _host + ":" + _wifi_port);
+        strncpy_P(buffer, text, size - 1);
     }
-    else if (_camera >= HERO4)
+    else
     {
-        _wifi_client.println("Host: " + _host);
+        strncpy(buffer, text, size - 1);
     }
-    _wifi_client.println("Connection: Keep-Alive");
-    _wifi_client.println();
-
-    uint16_t response = listenResponse();
-    _wifi_client.stop();
+    buffer[size - 1] = '\0';
+}
 
-    if (response == 200)
+void GoProControl::printCredential(const char *text)
+{
+    if (_progmem_credentials)
     {
-        if (_debug)
-        {
-            _debug_port->println("Command: Accepted");
-        }
-        return true;
+        _debug_port->println((const __FlashStringHelper *)text);
     }
-    else if (response == 400)
+    else
     {
-        if (_debug)
-        {
-            _debug_port->println("Command: Bad request");
-        }
+        _debug_port->println(text);
     }
-    else if (response == 403)
+}
+
+uint8_t GoProControl::connectClient(const uint16_t timeout)
+{
+    if (_transport->connected())
     {
-        if (_debug)
-        {
-            _debug_port->println("Command: Wrong password");
-        }
+        _transport->close(); // for example the one tagMoment() leaves open
     }
-    else if (response == 410)
+
+    const uint32_t start_time = millis();
+    const bool result = _transport->connect(_host, _wifi_port, timeout);
+
+    if (!result)
     {
         if (_debug)
         {
-            _debug_port->println("Command: Failed");
+            _debug_port->println("Client not connected");
         }
+        return false;
     }
     else
     {
         if (_debug)
         {
-            _debug_port->println("Command: Other error");
+            _debug_port->println("Client connected");
         }
+        _connect_time = millis() - start_time;
+        _last_request = millis();
+        return true;
     }
-    return -1;
 }
 
-#if defined(ARDUINO_ARCH_ESP32)
-uint8_t GoProControl::sendBLERequest(const uint8_t request[])
+void GoProControl::setState(const uint8_t state)
 {
+    if (state == _state)
+    {
+        return;
+    }
+
+    const uint8_t old_state = _state;
+    _state = state;
+    _state_since = millis();
+
     if (_debug)
     {
-        _debug_port->println("BLE request:");
-        for (uint8_t i = 0; i <= 3; i++)
-        {
-            _debug_port->println(request[i]);
-        }
+        _debug_port->print("State: ");
+        _debug_port->print(old_state);
+        _debug_port->print(" -> ");
+        _debug_port->println(state);
+    }
+    if (_state_callback != NULL)
+    {
+        _state_callback(this, old_state, state);
     }
 }
-#endif
 
-uint8_t GoProControl::connectClient()
+void GoProControl::updateHealth(const bool reached)
 {
-    if (!_wifi_client.connect(_host.c_str(), _wifi_port))
+    if (reached)
     {
-        if (_debug)
+        _failed_requests = 0;
+        _reconnect_delay = RECONNECT_MIN_DELAY;
+        if (_state == CAMERA_DEGRADED || _state == CAMERA_ASLEEP)
         {
-            _debug_port->println("Connection lost");
+            setState(CAMERA_CONNECTED);
         }
+        return;
+    }
+
+    if (WiFi.status() != WL_CONNECTED)
+    {
         _connected = false;
-        return false;
+        setState(CAMERA_DISCONNECTED);
+        return;
+    }
+
+    // still associated: the access point is there but the camera doesn't answer
+    if (_failed_requests < MAX_FAILED_REQUESTS)
+    {
+        _failed_requests++;
+    }
+    if (_failed_requests >= MAX_FAILED_REQUESTS)
+    {
+        if (_state == CAMERA_ASLEEP)
+        {
+            _reconnect_delay = min(_reconnect_delay * 2, (uint32_t)RECONNECT_MAX_DELAY);
+        }
+        setState(CAMERA_ASLEEP);
     }
     else
     {
-        if (_debug)
+        setState(CAMERA_DEGRADED);
+    }
+}
+
+void GoProControl::monitorConnection()
+{
+    if (_wanted == false || WIFI_MODE == false) // the sketch doesn't want to be connected, or the WiFi of the camera is off
+    {
+        return;
+    }
+
+    switch (_state)
+    {
+    case CAMERA_CONNECTED:
+    case CAMERA_DEGRADED:
+    case CAMERA_ASLEEP:
+        if (WiFi.status() != WL_CONNECTED)
         {
-            _debug_port->println("Client connected");
+            if (_debug)
+            {
+                _debug_port->println("WiFi connection lost");
+            }
+            _connected = false;
+            setState(CAMERA_DISCONNECTED);
         }
-        _last_request = millis();
-        return true;
+        break;
+
+    case CAMERA_DISCONNECTED:
+        if (_auto_reconnect && millis() - _state_since >= _reconnect_delay)
+        {
+            if (_debug)
+            {
+                _debug_port->print("Reconnecting to SSID: ");
+                printCredential(_ssid);
+            }
+            startWiFi();
+            setState(CAMERA_ASSOCIATING);
+        }
+        break;
+
+    case CAMERA_ASSOCIATING:
+        if (WiFi.status() == WL_CONNECTED)
+        {
+            _connected = true;
+            _failed_requests = 0;
+            _reconnect_delay = RECONNECT_MIN_DELAY;
+            setState(CAMERA_CONNECTED);
+        }
+        else if (millis() - _state_since >= ASSOCIATION_TIMEOUT)
+        {
+            // try again later with exponential backoff plus jitter, so many boards don't retry together
+            _reconnect_delay = min(_reconnect_delay * 2, (uint32_t)RECONNECT_MAX_DELAY);
+            _reconnect_delay += random(_reconnect_delay / 4 + 1);
+            setState(CAMERA_DISCONNECTED);
+        }
+        break;
     }
 }
 
@@ -1510,7 +3390,7 @@ uint8_t GoProControl::confirmPairing()
         return false;
     }
 
-    if (_camera == HERO3)
+    if (HERO3_DIALECT)
     {
         if (_debug)
         {
@@ -1528,54 +3408,62 @@ uint8_t GoProControl::confirmPairing()
     }
     else if (_camera >= HERO5)
     {
-        _request = "/gp/gpControl/command/wireless/pair/complete?success=1&deviceName=" + _board_name;
+        snprintf(_request, LEN(_request), "/gp/gpControl/command/wireless/pair/complete?success=1&deviceName=%s", _board_name);
     }
 
-    return sendHTTPRequest(_request);
+    return sendHTTPRequest(_request, CONTROL_COMMAND);
 }
 
-uint16_t GoProControl::listenResponse()
+uint16_t GoProControl::listenResponse(const uint16_t first_byte_timeout, const uint32_t deadline, const bool whole)
 {
-    char incoming;
-    char first_line[20];
-    bool first_line_completed = false;
-    uint8_t index = 0;
+    uint8_t chunk[32]; // bytes read from the transport
+    int16_t count;
 
     if (_debug)
     {
-        _debug_port->print("Waiting response");
+        _debug_port->println("Waiting response");
     }
 
-    uint32_t start_time = millis();
-    while (_wifi_client.available() == 0 && start_time + MAX_WAIT_TIME > millis())
+    _response.reset(_parser, whole);
+    const uint32_t start_time = millis();
+    while ((count = _transport->read(chunk, LEN(chunk))) == 0)
     {
-        delay(5);
-        if (_debug)
+        const int32_t left = min((int32_t)(first_byte_timeout - (millis() - start_time)), (int32_t)(deadline - millis()));
+        if (left <= 0)
         {
-            _debug_port->print(".");
+            break;
         }
+        _transport->waitForData(left); // wakes up as soon as the answer arrives
     }
+    _first_byte_at = millis();
 
     if (_debug)
     {
-        _debug_port->println("\nStart response body");
+        _debug_port->println("Start response body");
     }
 
-    while (_wifi_client.available() > 0)
+    while (count >= 0)
     {
-        incoming = _wifi_client.read();
-        if (first_line_completed == false)
+        for (int16_t i = 0; i < count && !_response.completed(); i++)
         {
-            first_line[index++] = incoming;
-            if (incoming == '\n')
+            if (_debug)
             {
-                first_line_completed = true;
+                _debug_port->print((char)chunk[i]);
             }
+            _response.feed(chunk[i]);
         }
-        if (_debug)
+
+        const int32_t left = deadline - millis();
+        if (_response.completed() || left <= 0 ||
+            (count == 0 && _response.code() == 0 && !_response.waitingLine())) // nothing arrived
+        {
+            break;
+        }
+        if (count == 0)
         {
-            _debug_port->print(incoming);
+            _transport->waitForData(left);
         }
+        count = _transport->read(chunk, LEN(chunk));
     }
 
     if (_debug)
@@ -1583,7 +3471,7 @@ uint16_t GoProControl::listenResponse()
         _debug_port->println("\nEnd response body");
     }
 
-    if (first_line[0] == NULL) // empty response
+    if (_response.code() == 0) // empty response
     {
         if (_debug)
         {
@@ -1592,43 +3480,25 @@ uint16_t GoProControl::listenResponse()
         return false;
     }
 
-    uint16_t response_code = atoi(splitString(first_line, 1));
-
     if (_debug)
     {
         _debug_port->print("Response code: ");
-        _debug_port->println(response_code);
+        _debug_port->println(_response.code());
     }
 
-    return response_code;
-}
-
-char *GoProControl::splitString(char str[], uint8_t index)
-{
-    uint8_t counter = 0;
-    char *token = strtok(str, " ");
-    while (token != NULL)
-    {
-        if (counter == index)
-        {
-            return token;
-        }
-        token = strtok(NULL, " ");
-        counter++;
-    }
-    return NULL;
+    return _response.code();
 }
 
 void GoProControl::printMacAddress(const uint8_t mac[])
 {
-    for (int8_t i = 5; i >= 0; i--)
+    for (uint8_t i = 0; i < MAC_SIZE; i++)
     {
         if (mac[i] < 16)
         {
             _debug_port->print("0");
         }
         _debug_port->print(mac[i], HEX);
-        if (i > 0)
+        if (i < MAC_SIZE - 1)
         {
             _debug_port->print(":");
         }
@@ -1638,9 +3508,27 @@ void GoProControl::printMacAddress(const uint8_t mac[])
 
 void GoProControl::getBSSID()
 {
-#if defined(ARDUINO_ARCH_ESP32) // ESP32 is not compliant with the arduino API
-    _gopro_mac = WiFi.BSSID();
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266) // not compliant with the arduino API
+    // a pointer into the WiFi library, valid until the next connection: copy it now
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid != NULL)
+    {
+        macCopy(_gopro_mac, bssid);
+    }
+#else
+    uint8_t bssid[MAC_SIZE];
+    WiFi.BSSID(bssid);
+    macReverse(_gopro_mac, bssid);
+#endif
+}
+
+void GoProControl::getBoardMac()
+{
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    WiFi.macAddress(_board_mac);
 #else
-    WiFi.BSSID(_gopro_mac);
+    uint8_t mac[MAC_SIZE];
+    WiFi.macAddress(mac);
+    macReverse(_board_mac, mac);
 #endif
 }
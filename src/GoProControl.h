@@ -22,6 +22,19 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 #include <Arduino.h>
 #include <Settings.h>
+#include <StatusParser.h>
+#include <HttpResponse.h>
+#include <Dialects.h>
+#include <Capabilities.h>
+#include <EspAtClient.h>
+#include <MacAddress.h>
+#include <Transport.h>
+#include <ClientTransport.h>
+#include <RecordingTransport.h>
+#include <AsyncTransport.h>
+#include <BleLink.h>
+#include <BleControl.h>
+#include <Esp32BleLink.h>
 
 // include the correct wifi library
 #if defined(ARDUINO_ARCH_ESP32) // ESP32
@@ -36,6 +49,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #elif defined(ARDUINO_SAMD_MKRVIDOR4000) // MKR VIDOR 4000
 #include <VidorPeripherals.h>
 #include <WiFiNINA.h>
+#elif !defined(ARDUINO) // Linux and macOS, with the Arduino API of extras/host
+#include <WiFi.h>
 #else // any board (like arduino UNO) without wifi + ESP01 with AT commands
 #include <WiFiEsp.h>
 #include <WiFiEspUdp.h>
@@ -57,36 +72,139 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #define UniversalSerial HardwareSerial
 #endif
 
+// timeouts are in milliseconds, the deadline includes every retry and backoff
+struct RequestPolicy
+{
+    uint16_t connect_timeout;    // open the TCP connection, ignored by the WiFi libraries of boards other than ESP32 (see README)
+                                 // for CONTROL_COMMAND also the WiFi association in begin()
+    uint16_t first_byte_timeout; // wait for the first byte of the response
+    uint16_t deadline;           // total time budget of the command
+    uint8_t retries;             // attempts after the first one
+    uint16_t backoff;            // wait before the first retry, doubled on every retry
+    uint16_t max_backoff;        // upper limit of the backoff
+    uint8_t jitter;              // random extra backoff, in percent of the backoff
+    bool idempotent;             // if false a request already written to the camera is never sent again
+};
+
+// one camera in the snapshot of pollAllStatus(), -1 where the camera didn't tell (HERO3 answers in binary)
+struct CameraStatus
+{
+    uint16_t code;       // HTTP code of the answer, 0 if the camera wasn't reached
+    uint16_t round_trip; // from the request to the first byte of the answer
+    int8_t recording;    // status 8
+    int8_t mode;         // status 43
+    int8_t battery;      // status 70, percent
+    int32_t video_left;  // status 35, recording time left on the SD card
+};
+
+// one camera of pollAllStatus() or commandAll() while its answer comes. The caller owns them, about
+// 200 bytes each: a global array on small boards, not the stack. See README
+#define STATUS_FIELD_COUNT 4 // recording, mode, battery, video left
+struct GroupSlot
+{
+    char values[STATUS_FIELD_COUNT][STATUS_VALUE_SIZE];
+    StatusParser parser;
+    uint8_t state;
+    uint16_t code; // HTTP code, 0 if the camera wasn't reached
+    uint32_t sent_at;
+    uint32_t first_byte_at;
+
+    GroupSlot();
+};
+
+class GoProControl;
+typedef void (*StateCallback)(GoProControl *camera, const uint8_t old_state, const uint8_t new_state);
+typedef void (*CommandCallback)(GoProControl *camera, const uint8_t result);
+typedef void (*StatusCallback)(GoProControl *camera, const uint8_t changed, const CameraStatus &status);
+
 class GoProControl
 {
   public:
     // Constructors
-    GoProControl(const String ssid, const String pwd, const uint8_t camera, const uint8_t gopro_mac[] = NULL, const String board_name = "");
+    GoProControl(const char *ssid, const char *pwd, const uint8_t camera, const uint8_t gopro_mac[] = NULL, const char *board_name = "");
+    GoProControl(const __FlashStringHelper *ssid, const __FlashStringHelper *pwd, const uint8_t camera, const uint8_t gopro_mac[] = NULL, const char *board_name = "");
+    __attribute__((deprecated("pass ssid.c_str() and pwd.c_str(), they are copied as well")))
+    GoProControl(const String &ssid, const String &pwd, const uint8_t camera, const uint8_t gopro_mac[] = NULL, const String &board_name = "");
 
     // Comunication
     uint8_t begin();
     void end();
     uint8_t keepAlive();
+    uint32_t nextKeepAlive();
+    void setTransport(Transport *transport);
+#if defined(GOPRO_RECORDER)
+    void startRecording(Print &log);
+    void stopRecording();
+#endif
 
-// BLE functions are availables only on ESP32
-#if defined(ARDUINO_ARCH_ESP32)
-    // none of these function will work, I am adding these for a proof of concept, see the readME
+#if defined(AT_COMMAND) && defined(GOPRO_ESP_AT_CLIENT)
+    uint8_t setEspSerial(Stream &serial, const bool keep_alive = true);
+#endif
+
+    // Camera detection
+    uint8_t detectCamera();
+    uint8_t getCamera();
+    void forgetCamera();
+
+    // Connection health
+    uint8_t getState();
+    void onStateChange(StateCallback callback);
+    void setAutoReconnect(const bool enable);
+
+#if defined(GOPRO_BLE_CONTROL)
+    // BLE: shoot(), stopShoot() and setMode() go over Bluetooth while the WiFi of the camera is off
     // https://github.com/KonradIT/goprowifihack/blob/master/HERO5/HERO5-Commands.md#bluetooth-pairing
+    void setBleLink(BleLink *link);
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_BLE)
+    void setBleCamera(const char *camera); // name or address the built in link connects to
+#endif
     uint8_t enableBLE();
     uint8_t disableBLE();
     uint8_t wifiOff();
     uint8_t wifiOn();
+
+    // Power saving: BLE for the shutter, the access point of the camera only when needed
+    void setPowerSaving(const bool enable, const uint32_t idle_timeout = WIFI_IDLE_TIMEOUT);
+    uint8_t wakeWiFi();
+    void getRadioTime(uint32_t &wifi, uint32_t &ble);
 #endif
 
     // Control
     uint8_t turnOn();
     uint8_t turnOff(const bool force = false);
     uint8_t isOn();
+#if defined(GOPRO_STATUS_EVENTS)
+    uint8_t onStatusChange(const uint8_t field_mask, StatusCallback callback);
+#endif
+    const CameraStatus &getStatus();
     uint8_t checkConnection(const bool silent = false);
 
     // Shoot
     uint8_t shoot();
     uint8_t stopShoot();
+    uint8_t shootAndConfirm(const uint16_t deadline = CONFIRM_DEADLINE);
+    uint8_t stopAndConfirm(const uint16_t deadline = CONFIRM_DEADLINE);
+    uint16_t lastConfirmLatency();
+    uint16_t lastConfirmUncertainty();
+#if defined(GOPRO_SCHEDULE)
+    uint8_t scheduleShoot(const uint32_t at_millis);
+    uint8_t handleSchedule();
+    void cancelSchedule();
+    bool isScheduled();
+    int32_t lastScheduleError();
+    uint8_t armTrigger(const uint8_t pin, const uint8_t edge);
+    void disarmTrigger();
+    bool isArmed();
+    uint8_t handleTrigger();
+    uint32_t lastTriggerLatency();
+#endif
+#if defined(GOPRO_TAGS)
+    uint8_t tagMoment();
+    uint8_t queueTag();
+    uint8_t handleTags();
+    uint8_t tagsPending();
+    uint32_t lastTagLatency();
+#endif
 
     // Settings
     uint8_t setMode(const uint8_t option);
@@ -109,51 +227,232 @@ class GoProControl
     uint8_t deleteLast();
     uint8_t deleteAll();
 
+    // Capabilities
+    bool isSupported(const uint8_t setting, const uint8_t option);
+    uint8_t supportedOptions(const uint8_t setting, uint8_t options[], const uint8_t size);
+#if defined(GOPRO_CAMERA_INFO)
+    uint8_t readCameraInfo();
+    const char *getModelName();
+    const char *getFirmware();
+#endif
+
+    // Clock
+    uint8_t syncClock(const uint32_t unix_time, const uint16_t milliseconds = 0);
+    uint8_t getCameraTime(uint32_t &unix_time);
+    uint8_t getClockDrift(int32_t &drift, float &ppm);
+
+    // Timeouts and retries
+    void setPolicy(const uint8_t command_class, const RequestPolicy policy);
+    RequestPolicy getPolicy(const uint8_t command_class);
+    uint16_t lastRoundTrip();
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+    // Asynchronous commands, the callback runs in the AsyncTCP task
+    uint8_t commandAsync(const uint8_t command, CommandCallback callback);
+    uint8_t settingAsync(const uint8_t setting, const uint8_t option, CommandCallback callback);
+    bool isBusy();
+#endif
+
+    // Several cameras at once, slot_count of them at the same time
+    static uint8_t pollAllStatus(GoProControl *cameras[], const uint8_t count, CameraStatus snapshot[], GroupSlot slots[], const uint8_t slot_count, const uint16_t timeout = MAX_WAIT_TIME);
+    static uint8_t commandAll(GoProControl *cameras[], const uint8_t count, const uint8_t command, uint8_t results[], GroupSlot slots[], const uint8_t slot_count, const uint16_t timeout = MAX_WAIT_TIME);
+
     // Debug
     void enableDebug(UniversalSerial *debug_port, const uint32_t debug_baudrate = 115200);
     void disableDebug(bool endSerial = true);
     void printStatus();
 
   private:
+#if defined(AT_COMMAND) && defined(GOPRO_ESP_AT_CLIENT)
+    EspAtClient _wifi_client;
+#else
     WiFiClient _wifi_client;
+#endif
     WiFiUDP _udp_client;
-    const String _host = "10.5.5.9";
+    ClientTransport _client_transport; // the default one, on _wifi_client and _udp_client
+#if defined(GOPRO_RECORDER)
+    RecordingTransport _recorder; // in front of the transport between startRecording() and stopRecording()
+#endif
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+    AsyncTransport _async_transport;
+    Transport *_transport = &_async_transport;
+#else
+    Transport *_transport = &_client_transport;
+#endif
+    const char *const _host = "10.5.5.9";
     const uint16_t _wifi_port = 80;
     const uint8_t _udp_port = 9;
 
-    String _ssid;
-    String _pwd;
+    const char *_ssid; // _ssid_buffer, or the F() string in flash
+    const char *_pwd;
+    char _ssid_buffer[WIFI_SSID_SIZE] = ""; // the strings in RAM are copied, see the constructors
+    char _pwd_buffer[WIFI_PASSWORD_SIZE] = "";
+    bool _progmem_credentials = false; // _ssid and _pwd are in flash
     uint8_t _camera;
 
-    String _request;
-    String _parameter;
-    String _parameter2;
+    char _request[HTTP_PATH_SIZE];
+    char _auth[HERO3_AUTH_SIZE] = ""; // "?t=<password>" of the HERO3 requests
+    uint8_t _auth_length = 0;
 
-    uint8_t *_gopro_mac = (uint8_t *)malloc(6 * sizeof(uint8_t));
-    uint8_t *_board_mac = (uint8_t *)malloc(6 * sizeof(uint8_t));
-    String _board_name;
+    uint8_t _gopro_mac[MAC_SIZE] = {0};
+    uint8_t _board_mac[MAC_SIZE] = {0};
+    bool _gopro_mac_given = false; // passed to the constructor, kept by end()
+    char _board_name[BOARD_NAME_SIZE];
 
     bool WIFI_MODE = true;
     bool BLE_ENABLED = false;
+    bool _power_saving = false;
+    uint32_t _wifi_idle = WIFI_IDLE_TIMEOUT;
+    uint32_t _wifi_used_at = 0; // last WiFi request, keep alives excluded
+#if defined(GOPRO_BLE_CONTROL)
+    BleControl _ble;
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_BLE)
+    Esp32BleLink _esp32_ble_link;
+#endif
+    uint32_t _radio_since = 0; // radio times are counted up to here
+    uint32_t _wifi_time = 0;
+    uint32_t _ble_time = 0;
+#endif
 
     bool _connected = false;
     uint64_t _last_request;
 
+    uint8_t _state = CAMERA_DISCONNECTED;
+    StateCallback _state_callback = NULL;
+
+    // last status read by isOn() or pollAllStatus(), and who wants to know when it changes
+    CameraStatus _status = {0, 0, -1, -1, -1, -1};
+#if defined(GOPRO_STATUS_EVENTS)
+    struct StatusSubscription
+    {
+        uint8_t mask;
+        StatusCallback callback;
+    };
+    StatusSubscription _status_subscriptions[STATUS_SUBSCRIPTIONS] = {};
+    uint32_t _status_polled_at = 0;
+#endif
+    bool _auto_reconnect = true;
+    bool _wanted = false; // begin() was called and end() wasn't
+    uint8_t _failed_requests = 0;
+    uint32_t _state_since = 0;
+    uint32_t _reconnect_delay = RECONNECT_MIN_DELAY;
+
+    RequestPolicy _policies[command_class_last];
+    StatusParser *_parser = NULL;
+    HttpResponse _response;
+    uint16_t _round_trip = 0;   // from the request written to the first byte of the answer
+    uint16_t _connect_time = 0; // to open the TCP connection
+    uint32_t _first_byte_at;
+    uint16_t _confirm_latency = 0;
+    uint16_t _confirm_uncertainty = 0;
+
+    Capabilities _capabilities;
+    uint8_t _video_resolution = 0; // last resolution set, 0 if unknown
+#if defined(GOPRO_CAMERA_INFO)
+    char _model_name[STATUS_VALUE_SIZE] = "";
+    char _firmware[STATUS_VALUE_SIZE] = "";
+#endif
+    bool _detect = false; // AUTO_DETECT was passed to the constructor
+
+    uint32_t _clock_set_time = 0; // unix time given to the camera by syncClock()
+    uint32_t _clock_set_at;       // millis() when the camera was at _clock_set_time
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(GOPRO_ASYNC_TCP)
+    char _async_request[HTTP_REQUEST_SIZE];
+    uint16_t _async_length = 0;
+    volatile bool _async_busy = false;
+    uint32_t _async_sent_at;
+    CommandCallback _async_callback = NULL;
+    uint8_t startAsync(const uint8_t command_class, CommandCallback callback);
+    void finishAsync(const uint16_t code);
+    static void asyncEvent(void *arg, const uint8_t event, const uint8_t *data, const size_t size);
+#endif
+
+    // a shot scheduled or armed, checked by every request even without GOPRO_SCHEDULE
+    volatile bool _scheduled = false;
+    volatile bool _trigger_armed = false;
+#if defined(GOPRO_SCHEDULE)
+    char _scheduled_request[HTTP_REQUEST_SIZE]; // shared by the scheduled shot and the armed trigger
+    uint16_t _scheduled_length = 0;
+    bool _preopened = false;
+    uint32_t _scheduled_at;    // millis()
+    uint32_t _scheduled_at_us; // micros(), known once the connection is open
+    int32_t _schedule_error = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t _schedule_task = NULL; // cleared only by the task, when it ends
+    volatile bool _schedule_cancel = false;
+    static void scheduleTask(void *parameter);
+#endif
+
+    static GoProControl *_trigger_cameras[TRIGGER_SLOTS];
+    static void (*const _trigger_isrs[TRIGGER_SLOTS])();
+    template <uint8_t SLOT>
+    static void triggerIsr();
+    volatile bool _triggered = false;
+    volatile uint32_t _trigger_at_us = 0; // micros() of the edge
+    uint32_t _trigger_latency = 0;        // from the edge to the write of the request
+    uint32_t _trigger_checked_at;
+    uint8_t _trigger_pin;
+    uint8_t _trigger_slot;
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t _trigger_task = NULL;
+    static void triggerTask(void *parameter);
+#endif
+#endif
+
+#if defined(GOPRO_TAGS)
+    char _tag_request[TAG_REQUEST_SIZE]; // built once for _tag_camera
+    uint16_t _tag_length = 0;
+    uint8_t _tag_camera = AUTO_DETECT;
+    volatile uint32_t _tag_queue[TAG_QUEUE_SIZE]; // micros() of the taps not sent yet
+    volatile uint8_t _tag_head = 0;               // moved only by queueTag(), from one interrupt
+    volatile uint8_t _tag_tail = 0;               // moved only by handleTags()
+    uint32_t _tag_latency = 0;                    // from the tap to the write of the request
+#endif
+
     UniversalSerial *_debug_port;
-    bool _debug;
+    bool _debug = false;
 
+    void setup(const uint8_t camera, const uint8_t gopro_mac[]);
+    void startWiFi();
+    void readCredential(char buffer[], const uint8_t size, const char *text);
+    void printCredential(const char *text);
     void sendWoL();
-    uint8_t sendRequest(const String request);
-    uint8_t sendHTTPRequest(const String request);
-#if defined(ARDUINO_ARCH_ESP32)
-    uint8_t sendBLERequest(const uint8_t request[]);
+    uint8_t sendRequest(const char *request);
+    uint8_t sendHTTPRequest(const char *request, const uint8_t command_class, StatusParser *parser = NULL);
+    uint8_t sendSetting(const uint8_t setting, const uint8_t option, const char *name);
+    uint8_t probeCamera();
+    bool loadDetectedCamera();
+    void saveDetectedCamera();
+    uint8_t sendCommand(const uint8_t command, const uint8_t command_class, StatusParser *parser = NULL);
+    uint8_t sendDateTime(const uint32_t unix_time);
+    uint16_t buildHTTPRequest(const char *request, char buffer[], const uint16_t size);
+    uint8_t confirmRecording(const bool recording, const uint16_t deadline);
+#if defined(GOPRO_SCHEDULE)
+    uint8_t fireSchedule();
+    bool prepareShutter();
+    void onTrigger();
+    uint8_t fireTrigger();
+#endif
+#if defined(GOPRO_TAGS)
+    uint8_t sendTag(const uint32_t tapped_at);
 #endif
-    uint8_t connectClient();
+    static uint8_t runGroup(GoProControl *cameras[], const uint8_t count, const uint8_t command, GroupSlot slots[], const uint16_t timeout);
+    bool startRequest(const uint8_t command);
+    void updateStatus(const CameraStatus &status);
+    bool writeRequest();
+    bool useBLE();
+    void accountRadio();
+    uint8_t sendBLERequest(const uint8_t request[], const uint8_t size, const uint8_t command_class);
+    uint8_t connectClient(const uint16_t timeout);
+    void setState(const uint8_t state);
+    void updateHealth(const bool reached);
+    void monitorConnection();
     uint8_t confirmPairing();
-    uint16_t listenResponse();
-    char *splitString(char str[], uint8_t index);
+    uint16_t listenResponse(const uint16_t first_byte_timeout, const uint32_t deadline, const bool whole = false);
     void printMacAddress(const uint8_t mac[]);
     void getBSSID();
+    void getBoardMac();
 };
 
 #endif //GOPRO_CONTROL_H
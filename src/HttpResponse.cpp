@@ -0,0 +1,111 @@
+/*
+HttpResponse.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <HttpResponse.h>
+#define LEN(x) ((sizeof(x) / sizeof(0 [x])) / ((size_t)(!(sizeof(x) % sizeof(0 [x])))))
+
+HttpResponse::HttpResponse()
+{
+    reset();
+}
+
+void HttpResponse::reset(StatusParser *parser, const bool whole)
+{
+    _parser = parser;
+    _whole = whole;
+    if (_parser != NULL)
+    {
+        _parser->reset();
+    }
+    _line[0] = '\0';
+    _index = 0;
+    _first_line_completed = false;
+    _headers_completed = false;
+    _completed = false;
+    _code = 0;
+    _content_length = -1;
+    _body_length = 0;
+}
+
+bool HttpResponse::feed(const char c)
+{
+    if (_completed)
+    {
+        return true;
+    }
+
+    if (_headers_completed)
+    {
+        _body_length++;
+        if (_parser != NULL)
+        {
+            _parser->feed(c);
+        }
+        _completed = (_parser != NULL && _parser->completed()) || (_content_length >= 0 && _body_length >= _content_length);
+    }
+    else if (c == '\n')
+    {
+        _line[_index] = '\0';
+        if (_first_line_completed == false)
+        {
+            // HTTP/1.1 200 OK
+            _first_line_completed = true;
+            const char *space = strchr(_line, ' ');
+            _code = (space == NULL) ? 0 : atoi(space + 1);
+            _completed = (_parser == NULL && _whole == false);
+        }
+        else if (_index == 0)
+        {
+            _headers_completed = true;
+            // without Content-Length the body ends when the connection closes, don't wait for it
+            _completed = (_content_length == 0) || (_parser == NULL && _content_length < 0);
+        }
+        else if (strncasecmp(_line, "Content-Length:", 15) == 0)
+        {
+            _content_length = atol(_line + 15);
+        }
+        _index = 0;
+    }
+    else if (c != '\r' && _index < LEN(_line) - 1)
+    {
+        _line[_index++] = c;
+    }
+    return _completed;
+}
+
+bool HttpResponse::completed()
+{
+    return _completed;
+}
+
+bool HttpResponse::reusable()
+{
+    return _headers_completed && _content_length >= 0 && _body_length == _content_length;
+}
+
+bool HttpResponse::waitingLine()
+{
+    return _first_line_completed == false && _index > 0;
+}
+
+uint16_t HttpResponse::code()
+{
+    return _code;
+}
@@ -0,0 +1,55 @@
+/*
+HttpResponse.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HTTP_RESPONSE_H
+#define HTTP_RESPONSE_H
+
+#include <Arduino.h>
+#include <StatusParser.h>
+
+// The answer of the camera fed one byte at a time, from a polling loop or from a network callback:
+// the status line, Content-Length and, if a parser is attached, the body. Without a parser the
+// status line is enough, unless whole is set: then the body is skipped up to Content-Length so
+// the connection can carry the next request
+class HttpResponse
+{
+  public:
+    HttpResponse();
+
+    void reset(StatusParser *parser = NULL, const bool whole = false);
+    bool feed(const char c); // true when nothing else is needed
+    bool completed();
+    bool waitingLine(); // a line started but not finished, don't give up yet
+    bool reusable();    // the whole answer was read and nothing of it is left on the connection
+    uint16_t code();    // 0 until the status line arrived
+
+  private:
+    StatusParser *_parser;
+    bool _whole;
+    char _line[32]; // status line and headers, one at a time
+    uint8_t _index;
+    bool _first_line_completed;
+    bool _headers_completed;
+    bool _completed;
+    uint16_t _code;
+    int32_t _content_length;
+    int32_t _body_length;
+};
+
+#endif //HTTP_RESPONSE_H
@@ -0,0 +1,215 @@
+/*
+Intervalometer.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Intervalometer.h>
+
+Intervalometer::Intervalometer(GoProControl &camera)
+    : _camera(camera)
+{
+}
+
+void Intervalometer::start(const uint32_t period, const uint32_t shots, const uint32_t first_delay)
+{
+    _start = millis() + first_delay;
+    _period = period > 0 ? period : 1;
+    _shots = shots;
+    _slot = 0;
+    _taken = 0;
+    _skipped = 0;
+    _missed = 0;
+    _failed = 0;
+    _max_error = 0;
+    _log_next = 0;
+    _log_count = 0;
+    _running = true;
+}
+
+void Intervalometer::stop()
+{
+    _running = false;
+}
+
+bool Intervalometer::running()
+{
+    return _running;
+}
+
+uint8_t Intervalometer::handle()
+{
+    if (_running == false)
+    {
+        return false;
+    }
+
+    const uint32_t now = millis();
+    if ((int32_t)(now - slotTime(_slot)) < 0) // not yet
+    {
+        return false;
+    }
+
+    // we are late by more than a period: the older slots are gone
+    while ((int32_t)(now - slotTime(_slot + 1)) >= 0)
+    {
+        if (inHoldOff(_slot))
+        {
+            _skipped++;
+        }
+        else
+        {
+            _missed++;
+        }
+        _slot++;
+    }
+
+    if (inHoldOff(_slot))
+    {
+        _skipped++;
+        _slot++;
+        return false;
+    }
+
+    ShotRecord record;
+    record.index = _slot;
+    record.planned = slotTime(_slot);
+    record.error = (int32_t)(now - record.planned);
+    record.result = _camera.shoot();
+
+    _slot++;
+    _taken++;
+    if (record.result != true)
+    {
+        _failed++;
+    }
+    if (record.error > _max_error)
+    {
+        _max_error = record.error;
+    }
+
+    _log[_log_next] = record;
+    _log_next = (_log_next + 1) % INTERVALOMETER_LOG_SIZE;
+    if (_log_count < INTERVALOMETER_LOG_SIZE)
+    {
+        _log_count++;
+    }
+    if (_callback != NULL)
+    {
+        _callback(record);
+    }
+
+    if (_shots != 0 && _taken >= _shots)
+    {
+        _running = false;
+    }
+    return record.result;
+}
+
+uint8_t Intervalometer::addHoldOff(const uint32_t from, const uint32_t to, const uint32_t repeat)
+{
+    if (_hold_off_count >= INTERVALOMETER_HOLD_OFFS || (repeat != 0 && (from >= repeat || to > repeat)))
+    {
+        return false;
+    }
+    _hold_offs[_hold_off_count].from = from;
+    _hold_offs[_hold_off_count].to = to;
+    _hold_offs[_hold_off_count].repeat = repeat;
+    _hold_off_count++;
+    return true;
+}
+
+void Intervalometer::clearHoldOffs()
+{
+    _hold_off_count = 0;
+}
+
+uint32_t Intervalometer::nextShot()
+{
+    return slotTime(_slot);
+}
+
+uint32_t Intervalometer::shotsTaken()
+{
+    return _taken;
+}
+
+uint32_t Intervalometer::shotsSkipped()
+{
+    return _skipped;
+}
+
+uint32_t Intervalometer::shotsMissed()
+{
+    return _missed;
+}
+
+uint32_t Intervalometer::shotsFailed()
+{
+    return _failed;
+}
+
+int32_t Intervalometer::maxError()
+{
+    return _max_error;
+}
+
+uint8_t Intervalometer::getLog(ShotRecord records[], const uint8_t size)
+{
+    const uint8_t count = min(size, _log_count);
+    // the oldest of the last `count` records
+    uint8_t index = (_log_next + INTERVALOMETER_LOG_SIZE - count) % INTERVALOMETER_LOG_SIZE;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        records[i] = _log[index];
+        index = (index + 1) % INTERVALOMETER_LOG_SIZE;
+    }
+    return count;
+}
+
+void Intervalometer::onShot(ShotCallback callback)
+{
+    _callback = callback;
+}
+
+////////////////////////////////////////////////////////////
+////////                  Private                  /////////
+////////////////////////////////////////////////////////////
+
+// modulo 2^32 like millis(), so it stays right when millis() overflows
+uint32_t Intervalometer::slotTime(const uint32_t slot)
+{
+    return _start + slot * _period;
+}
+
+bool Intervalometer::inHoldOff(const uint32_t slot)
+{
+    const uint64_t offset = (uint64_t)slot * _period; // from start(), weeks don't fit in 32 bits of ms
+    for (uint8_t i = 0; i < _hold_off_count; i++)
+    {
+        const HoldOff &hold_off = _hold_offs[i];
+        const uint64_t position = hold_off.repeat != 0 ? offset % hold_off.repeat : offset;
+        const bool inside = hold_off.from <= hold_off.to
+                                ? position >= hold_off.from && position < hold_off.to
+                                : position >= hold_off.from || position < hold_off.to;
+        if (inside)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,99 @@
+/*
+Intervalometer.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INTERVALOMETER_H
+#define INTERVALOMETER_H
+
+#include <GoProControl.h>
+
+// a shot as planned and as taken
+struct ShotRecord
+{
+    uint32_t index;   // slot number since start(), skipped and missed slots included
+    uint32_t planned; // millis()
+    int32_t error;    // actual - planned, in milliseconds
+    uint8_t result;   // what shoot() returned
+};
+
+typedef void (*ShotCallback)(const ShotRecord &record);
+
+// Shoots every period milliseconds on an absolute schedule: slot k is at start + k * period,
+// so a late shot doesn't move the next ones and the error never adds up. Call handle() in loop().
+// A slot that falls in a hold off window is skipped, slots already passed when handle() comes
+// back (a long blocking call, a slow camera) are missed: only the latest one is shot
+class Intervalometer
+{
+  public:
+    Intervalometer(GoProControl &camera);
+
+    // shots = 0 never stops, the first shot is first_delay milliseconds from now
+    void start(const uint32_t period, const uint32_t shots = 0, const uint32_t first_delay = 0);
+    void stop();
+    bool running();
+    uint8_t handle(); // true/-1 (see shoot()) when it shot, false otherwise
+
+    // no shots from `from` to `to` milliseconds after start(), every `repeat` ms if not 0
+    // (to < from crosses the repeat boundary: from 20h to 6h with repeat 24h)
+    uint8_t addHoldOff(const uint32_t from, const uint32_t to, const uint32_t repeat = 0);
+    void clearHoldOffs();
+
+    uint32_t nextShot(); // millis() of the next slot
+    uint32_t shotsTaken();
+    uint32_t shotsSkipped();
+    uint32_t shotsMissed();
+    uint32_t shotsFailed();
+    int32_t maxError();
+
+    // the last INTERVALOMETER_LOG_SIZE shots, oldest first
+    uint8_t getLog(ShotRecord records[], const uint8_t size);
+    void onShot(ShotCallback callback);
+
+  private:
+    struct HoldOff
+    {
+        uint32_t from;
+        uint32_t to;
+        uint32_t repeat;
+    };
+
+    GoProControl &_camera;
+    bool _running = false;
+    uint32_t _start;  // millis() of slot 0
+    uint32_t _period;
+    uint32_t _shots;
+    uint32_t _slot;   // next slot
+    uint32_t _taken = 0;
+    uint32_t _skipped = 0;
+    uint32_t _missed = 0;
+    uint32_t _failed = 0;
+    int32_t _max_error = 0;
+
+    HoldOff _hold_offs[INTERVALOMETER_HOLD_OFFS];
+    uint8_t _hold_off_count = 0;
+
+    ShotRecord _log[INTERVALOMETER_LOG_SIZE];
+    uint8_t _log_next = 0;
+    uint8_t _log_count = 0;
+    ShotCallback _callback = NULL;
+
+    uint32_t slotTime(const uint32_t slot);
+    bool inHoldOff(const uint32_t slot);
+};
+
+#endif //INTERVALOMETER_H
@@ -0,0 +1,56 @@
+/*
+MacAddress.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MAC_ADDRESS_H
+#define MAC_ADDRESS_H
+
+#include <stdint.h>
+#include <string.h>
+
+// MAC addresses are plain uint8_t[MAC_SIZE] members, first byte first: no heap and no pointers
+// into the buffers of the WiFi libraries, which change under our feet
+constexpr uint8_t MAC_SIZE = 6;
+constexpr uint8_t WOL_PACKET_SIZE = 6 + 16 * MAC_SIZE; // 6 times 0xFF then 16 times the mac
+
+// all zeros: not known yet
+constexpr bool macIsEmpty(const uint8_t mac[], const uint8_t i = 0)
+{
+    return i >= MAC_SIZE || (mac[i] == 0 && macIsEmpty(mac, i + 1));
+}
+
+inline void macCopy(uint8_t to[], const uint8_t from[])
+{
+    memcpy(to, from, MAC_SIZE);
+}
+
+// WiFi101, WiFiNINA and WiFiEsp give the last byte first
+inline void macReverse(uint8_t to[], const uint8_t from[])
+{
+    for (uint8_t i = 0; i < MAC_SIZE; i++)
+    {
+        to[i] = from[MAC_SIZE - 1 - i];
+    }
+}
+
+inline void macClear(uint8_t mac[])
+{
+    memset(mac, 0, MAC_SIZE);
+}
+
+#endif //MAC_ADDRESS_H
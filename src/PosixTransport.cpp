@@ -0,0 +1,288 @@
+/*
+PosixTransport.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <PosixTransport.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if !defined(MSG_NOSIGNAL) // macOS
+#define MSG_NOSIGNAL 0
+#endif
+
+static bool toAddress(const char *host, const uint16_t port, sockaddr_in &address)
+{
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    return inet_pton(AF_INET, host, &address.sin_addr) == 1;
+}
+
+PosixTransport::PosixTransport()
+{
+    _socket = -1;
+    _connecting = false;
+    _interface[0] = '\0';
+}
+
+PosixTransport::~PosixTransport()
+{
+    close();
+}
+
+bool PosixTransport::connect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+    if (!startConnect(host, port, timeout))
+    {
+        return false;
+    }
+    if (_connecting)
+    {
+        pollfd descriptor = {_socket, POLLOUT, 0};
+        if (poll(&descriptor, 1, timeout) != 1)
+        {
+            close();
+            return false;
+        }
+    }
+    return finishConnect() == 1;
+}
+
+bool PosixTransport::startConnect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+    close();
+
+    sockaddr_in address;
+    if (!toAddress(host, port, address))
+    {
+        return false;
+    }
+
+    _socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (_socket < 0)
+    {
+        return false;
+    }
+    if (!bindSocket(_socket))
+    {
+        close();
+        return false;
+    }
+
+    // non blocking, so the connect can have a timeout and read() never waits
+    fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK);
+    const int one = 1;
+    setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (::connect(_socket, (sockaddr *)&address, sizeof(address)) < 0)
+    {
+        if (errno != EINPROGRESS)
+        {
+            close();
+            return false;
+        }
+        _connecting = true;
+    }
+    return true;
+}
+
+int8_t PosixTransport::finishConnect()
+{
+    if (_socket < 0)
+    {
+        return -1;
+    }
+    if (!_connecting)
+    {
+        return 1;
+    }
+
+    pollfd descriptor = {_socket, POLLOUT, 0};
+    if (poll(&descriptor, 1, 0) != 1)
+    {
+        return 0;
+    }
+
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(_socket, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0)
+    {
+        close();
+        return -1;
+    }
+    _connecting = false;
+    return 1;
+}
+
+int PosixTransport::descriptor()
+{
+    return _socket;
+}
+
+bool PosixTransport::bindToDevice(const char *interface)
+{
+    if (interface == NULL || interface[0] == '\0')
+    {
+        _interface[0] = '\0';
+        return true;
+    }
+    if (strlen(interface) >= sizeof(_interface))
+    {
+        return false;
+    }
+    strcpy(_interface, interface);
+
+    // try it now rather than at the first request
+    const int probe = socket(AF_INET, SOCK_STREAM, 0);
+    const bool result = probe >= 0 && bindSocket(probe);
+    if (probe >= 0)
+    {
+        ::close(probe);
+    }
+    return result;
+}
+
+bool PosixTransport::bindSocket(const int socket)
+{
+    if (_interface[0] == '\0')
+    {
+        return true;
+    }
+#if defined(__linux__)
+    return setsockopt(socket, SOL_SOCKET, SO_BINDTODEVICE, _interface, strlen(_interface)) == 0;
+#else
+    const unsigned int index = if_nametoindex(_interface);
+    return index != 0 && setsockopt(socket, IPPROTO_IP, IP_BOUND_IF, &index, sizeof(index)) == 0;
+#endif
+}
+
+size_t PosixTransport::write(const uint8_t *buffer, const size_t size)
+{
+    size_t written = 0;
+    while (_socket >= 0 && written < size)
+    {
+        const ssize_t result = send(_socket, buffer + written, size - written, MSG_NOSIGNAL);
+        if (result > 0)
+        {
+            written += result;
+        }
+        else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            pollfd descriptor = {_socket, POLLOUT, 0};
+            if (poll(&descriptor, 1, 1000) != 1)
+            {
+                break;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+    return written;
+}
+
+int PosixTransport::read(uint8_t *buffer, const size_t size)
+{
+    if (_socket < 0)
+    {
+        return -1;
+    }
+
+    const ssize_t result = recv(_socket, buffer, size, 0);
+    if (result > 0)
+    {
+        return result;
+    }
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        return 0;
+    }
+    return -1; // closed by the camera or error
+}
+
+void PosixTransport::waitForData(const uint16_t timeout)
+{
+    if (_socket >= 0)
+    {
+        pollfd descriptor = {_socket, POLLIN, 0};
+        poll(&descriptor, 1, timeout);
+    }
+}
+
+bool PosixTransport::connected()
+{
+    if (_socket < 0)
+    {
+        return false;
+    }
+
+    uint8_t c;
+    const ssize_t result = recv(_socket, &c, 1, MSG_PEEK);
+    return result > 0 || (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+void PosixTransport::close()
+{
+    if (_socket >= 0)
+    {
+        ::close(_socket);
+        _socket = -1;
+    }
+    _connecting = false;
+}
+
+bool PosixTransport::sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size)
+{
+    sockaddr_in address;
+    if (!toAddress(host, port, address))
+    {
+        return false;
+    }
+
+    const int datagram = socket(AF_INET, SOCK_DGRAM, 0);
+    if (datagram < 0)
+    {
+        return false;
+    }
+
+    if (!bindSocket(datagram))
+    {
+        ::close(datagram);
+        return false;
+    }
+
+    const int one = 1;
+    setsockopt(datagram, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+    const ssize_t result = sendto(datagram, buffer, size, 0, (sockaddr *)&address, sizeof(address));
+    ::close(datagram);
+    return result == (ssize_t)size;
+}
+
+#endif
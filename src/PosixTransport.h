@@ -0,0 +1,61 @@
+/*
+PosixTransport.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef POSIX_TRANSPORT_H
+#define POSIX_TRANSPORT_H
+
+#include <Transport.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <net/if.h>
+
+// Transport on BSD sockets, to drive the cameras from a computer (gateway, tests, benchmarks)
+class PosixTransport : public Transport
+{
+  public:
+    PosixTransport();
+    ~PosixTransport();
+
+    bool connect(const char *host, const uint16_t port, const uint16_t timeout);
+    size_t write(const uint8_t *buffer, const size_t size);
+    int read(uint8_t *buffer, const size_t size);
+    void waitForData(const uint16_t timeout);
+    bool connected();
+    void close();
+    bool startConnect(const char *host, const uint16_t port, const uint16_t timeout);
+    int8_t finishConnect();
+    int descriptor();
+
+    // every camera is 10.5.5.9: on a computer with a WiFi adapter per camera the interface
+    // ("wlan1") picks which one, false if the name is wrong or we may not bind (CAP_NET_RAW on Linux)
+    bool bindToDevice(const char *interface);
+    bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size);
+
+  private:
+    int _socket;
+    bool _connecting; // startConnect() called, the handshake isn't finished yet
+    char _interface[IFNAMSIZ];
+
+    bool bindSocket(const int socket);
+};
+
+#endif
+
+#endif //POSIX_TRANSPORT_H
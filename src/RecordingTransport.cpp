@@ -0,0 +1,198 @@
+/*
+RecordingTransport.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <RecordingTransport.h>
+
+void RecordingTransport::begin(Transport *transport, Print *log)
+{
+    _transport = transport;
+    _log = log;
+    _recorded = 0;
+    _connecting = false;
+    _closed = false;
+    _last_at = millis();
+
+    const uint8_t header[] = {TRANSCRIPT_MAGIC[0], TRANSCRIPT_MAGIC[1], TRANSCRIPT_MAGIC[2], TRANSCRIPT_MAGIC[3], TRANSCRIPT_VERSION};
+    _recorded += _log->write(header, sizeof(header));
+}
+
+void RecordingTransport::setTransport(Transport *transport)
+{
+    _transport = transport;
+}
+
+Transport *RecordingTransport::getTransport()
+{
+    return _transport;
+}
+
+uint32_t RecordingTransport::recorded()
+{
+    return _recorded;
+}
+
+bool RecordingTransport::connect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+    _host = host;
+    _port = port;
+    _connect_at = millis();
+    const bool result = _transport->connect(host, port, timeout);
+    recordConnect(result);
+    return result;
+}
+
+bool RecordingTransport::startConnect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+    _host = host;
+    _port = port;
+    _connect_at = millis();
+    const bool result = _transport->startConnect(host, port, timeout);
+    if (!result)
+    {
+        recordConnect(false);
+        return false;
+    }
+    _connecting = true;
+    return true;
+}
+
+int8_t RecordingTransport::finishConnect()
+{
+    const int8_t result = _transport->finishConnect();
+    if (_connecting && result != 0)
+    {
+        recordConnect(result == 1);
+    }
+    return result;
+}
+
+size_t RecordingTransport::write(const uint8_t *buffer, const size_t size)
+{
+    const size_t written = _transport->write(buffer, size);
+    record(TRANSCRIPT_WRITE, buffer, written);
+    return written;
+}
+
+int RecordingTransport::read(uint8_t *buffer, const size_t size)
+{
+    const int count = _transport->read(buffer, size);
+    if (count > 0)
+    {
+        record(TRANSCRIPT_READ, buffer, count);
+    }
+    else if (count < 0 && !_closed)
+    {
+        _closed = true;
+        record(TRANSCRIPT_CLOSED, NULL, 0);
+    }
+    return count;
+}
+
+void RecordingTransport::waitForData(const uint16_t timeout)
+{
+    _transport->waitForData(timeout);
+}
+
+bool RecordingTransport::connected()
+{
+    return _transport->connected();
+}
+
+void RecordingTransport::close()
+{
+    if (_connecting) // given up before the connection was open
+    {
+        recordConnect(false);
+    }
+    _transport->close();
+    record(TRANSCRIPT_CLOSE, NULL, 0);
+}
+
+int RecordingTransport::descriptor()
+{
+    return _transport->descriptor();
+}
+
+bool RecordingTransport::sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size)
+{
+    const bool result = _transport->sendDatagram(host, port, buffer, size);
+
+    uint8_t head[24];
+    const size_t host_length = min(strlen(host), sizeof(head) - 4);
+    head[0] = result;
+    head[1] = port & 0xFF;
+    head[2] = port >> 8;
+    memcpy(head + 3, host, host_length);
+    head[3 + host_length] = 0;
+    record(TRANSCRIPT_DATAGRAM, head, host_length + 4, buffer, size);
+    return result;
+}
+
+void RecordingTransport::recordConnect(const bool result)
+{
+    _connecting = false;
+    _closed = false;
+
+    uint8_t head[32];
+    uint32_t duration = millis() - _connect_at;
+    size_t length = 0;
+    head[length++] = result;
+    do // the duration as a varint, like the numbers of the record
+    {
+        head[length++] = (duration & 0x7F) | (duration > 0x7F ? 0x80 : 0);
+        duration >>= 7;
+    } while (duration > 0);
+    head[length++] = _port & 0xFF;
+    head[length++] = _port >> 8;
+    const size_t host_length = min(strlen(_host), sizeof(head) - length);
+    memcpy(head + length, _host, host_length);
+    record(TRANSCRIPT_CONNECT, head, length + host_length);
+}
+
+void RecordingTransport::record(const uint8_t type, const uint8_t *head, const size_t head_size, const uint8_t *body, const size_t body_size)
+{
+    if (_log == NULL)
+    {
+        return;
+    }
+
+    const uint32_t now = millis();
+    _recorded += _log->write(type);
+    writeNumber(now - _last_at);
+    writeNumber(head_size + body_size);
+    if (head_size > 0)
+    {
+        _recorded += _log->write(head, head_size);
+    }
+    if (body_size > 0)
+    {
+        _recorded += _log->write(body, body_size);
+    }
+    _last_at = now;
+}
+
+void RecordingTransport::writeNumber(uint32_t number)
+{
+    do
+    {
+        _recorded += _log->write((uint8_t)((number & 0x7F) | (number > 0x7F ? 0x80 : 0)));
+        number >>= 7;
+    } while (number > 0);
+}
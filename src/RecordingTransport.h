@@ -0,0 +1,79 @@
+/*
+RecordingTransport.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RECORDING_TRANSPORT_H
+#define RECORDING_TRANSPORT_H
+
+#include <Arduino.h>
+#include <Transport.h>
+
+// Transcript: "GPTR" and the version, then one record for every call that talks to the camera:
+// <type> <ms since the previous record> <payload length> <payload>, numbers are LEB128 varints
+#define TRANSCRIPT_MAGIC "GPTR"
+#define TRANSCRIPT_VERSION 1
+
+enum transcript_record
+{
+    TRANSCRIPT_CONNECT = 1, // <result> <ms the connection took> <port, little endian> <host>
+    TRANSCRIPT_WRITE,       // the bytes written
+    TRANSCRIPT_READ,        // the bytes read, empty reads are not recorded
+    TRANSCRIPT_CLOSED,      // read() found the connection closed
+    TRANSCRIPT_CLOSE,       // close()
+    TRANSCRIPT_DATAGRAM     // <result> <port, little endian> <host> 0 <the bytes>
+};
+
+// Passes every call to another transport and writes what happened to a log (Serial, a file
+// on an SD card, a buffer), ReplayTransport plays it back without the camera. See
+// GoProControl::startRecording()
+class RecordingTransport : public Transport
+{
+  public:
+    void begin(Transport *transport, Print *log); // writes the header
+    void setTransport(Transport *transport);
+    Transport *getTransport();
+    uint32_t recorded(); // bytes written to the log
+
+    bool connect(const char *host, const uint16_t port, const uint16_t timeout);
+    size_t write(const uint8_t *buffer, const size_t size);
+    int read(uint8_t *buffer, const size_t size);
+    void waitForData(const uint16_t timeout);
+    bool connected();
+    void close();
+    bool startConnect(const char *host, const uint16_t port, const uint16_t timeout);
+    int8_t finishConnect();
+    int descriptor();
+    bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size);
+
+  private:
+    Transport *_transport = NULL;
+    Print *_log = NULL;
+    uint32_t _recorded = 0;
+    uint32_t _last_at;      // millis() of the previous record
+    uint32_t _connect_at;   // millis() of startConnect()
+    bool _connecting = false;
+    bool _closed = false;   // TRANSCRIPT_CLOSED already written for this connection
+    const char *_host;
+    uint16_t _port;
+
+    void recordConnect(const bool result);
+    void record(const uint8_t type, const uint8_t *head, const size_t head_size, const uint8_t *body = NULL, const size_t body_size = 0);
+    void writeNumber(uint32_t number);
+};
+
+#endif //RECORDING_TRANSPORT_H
@@ -0,0 +1,278 @@
+/*
+ReplayTransport.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <ReplayTransport.h>
+
+ReplayTransport::ReplayTransport(const uint8_t *transcript, const size_t size, const float speed)
+    : _data(transcript), _size(size), _speed(speed)
+{
+    _valid = _size > 4 && memcmp(_data, TRANSCRIPT_MAGIC, 4) == 0 && _data[4] == TRANSCRIPT_VERSION;
+    rewind();
+}
+
+void ReplayTransport::rewind()
+{
+    _next = 5;
+    _open = false;
+    _mismatch = false;
+    _mismatch_at = 0;
+    _previous_at = millis();
+    parse();
+}
+
+bool ReplayTransport::valid()
+{
+    return _valid;
+}
+
+bool ReplayTransport::finished()
+{
+    return _type == 0;
+}
+
+bool ReplayTransport::mismatch()
+{
+    return _mismatch;
+}
+
+size_t ReplayTransport::position()
+{
+    return _mismatch ? _mismatch_at : _next;
+}
+
+bool ReplayTransport::connect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+    if (!startConnect(host, port, timeout))
+    {
+        return false;
+    }
+
+    int8_t result;
+    while ((result = finishConnect()) == 0)
+    {
+        delay(1);
+    }
+    return result == 1;
+}
+
+bool ReplayTransport::startConnect(const char *host, const uint16_t port, const uint16_t timeout)
+{
+    _open = false;
+    if (!expect(TRANSCRIPT_CONNECT))
+    {
+        return false;
+    }
+
+    size_t offset = _payload;
+    uint32_t duration = 0;
+    const bool result = _length > 0 && _data[offset++] == 1;
+    readNumber(offset, duration);
+    const uint16_t recorded_port = _data[offset] | (_data[offset + 1] << 8);
+    offset += 2;
+    const size_t host_length = _payload + _length - offset;
+    if (recorded_port != port || host_length != strlen(host) || memcmp(_data + offset, host, host_length) != 0)
+    {
+        _mismatch_at = _mismatch ? _mismatch_at : _next;
+        _mismatch = true;
+    }
+    advance();
+
+    _connect_result = result;
+    _connect_ready_at = millis() + scaled(duration);
+    if (!result)
+    {
+        delay(scaled(duration)); // a failed connect returns only after its timeout
+    }
+    return result;
+}
+
+int8_t ReplayTransport::finishConnect()
+{
+    if (!_connect_result)
+    {
+        return -1;
+    }
+    if ((int32_t)(millis() - _connect_ready_at) < 0)
+    {
+        return 0;
+    }
+    _open = true;
+    return 1;
+}
+
+size_t ReplayTransport::write(const uint8_t *buffer, const size_t size)
+{
+    if (expect(TRANSCRIPT_WRITE))
+    {
+        if (_length != size || memcmp(_data + _payload, buffer, size) != 0)
+        {
+            _mismatch_at = _mismatch ? _mismatch_at : _next;
+            _mismatch = true;
+        }
+        advance();
+    }
+    return size;
+}
+
+int ReplayTransport::read(uint8_t *buffer, const size_t size)
+{
+    if (!_open)
+    {
+        return -1;
+    }
+    if ((_type != TRANSCRIPT_READ && _type != TRANSCRIPT_CLOSED) || !due())
+    {
+        return 0; // nothing more came in the recording
+    }
+
+    if (_type == TRANSCRIPT_CLOSED)
+    {
+        advance();
+        _open = false;
+        return -1;
+    }
+
+    const size_t count = min(size, _length - _consumed);
+    memcpy(buffer, _data + _payload + _consumed, count);
+    _consumed += count;
+    if (_consumed >= _length)
+    {
+        advance();
+    }
+    return count;
+}
+
+void ReplayTransport::waitForData(const uint16_t timeout)
+{
+    if (_open && (_type == TRANSCRIPT_READ || _type == TRANSCRIPT_CLOSED))
+    {
+        const int32_t left = scaled(_delay) - (millis() - _previous_at);
+        if (left > 0)
+        {
+            delay(min(left, (int32_t)timeout));
+        }
+        return;
+    }
+    delay(timeout); // the camera said nothing more in the recording
+}
+
+bool ReplayTransport::connected()
+{
+    return _open && !(_type == TRANSCRIPT_CLOSED && due());
+}
+
+void ReplayTransport::close()
+{
+    if (expect(TRANSCRIPT_CLOSE))
+    {
+        advance();
+    }
+    _open = false;
+}
+
+bool ReplayTransport::sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size)
+{
+    if (!expect(TRANSCRIPT_DATAGRAM))
+    {
+        return false;
+    }
+
+    const uint8_t *payload = _data + _payload;
+    const size_t host_length = strlen(host);
+    const bool result = payload[0] == 1;
+    if (_length != host_length + 4 + size || (payload[1] | (payload[2] << 8)) != port ||
+        memcmp(payload + 3, host, host_length) != 0 || memcmp(payload + 4 + host_length, buffer, size) != 0)
+    {
+        _mismatch_at = _mismatch ? _mismatch_at : _next;
+        _mismatch = true;
+    }
+    advance();
+    return result;
+}
+
+// reads the record at _next, _type is 0 at the end or if the record is broken
+void ReplayTransport::parse()
+{
+    _type = 0;
+    _consumed = 0;
+    if (!_valid || _next >= _size)
+    {
+        return;
+    }
+
+    size_t offset = _next + 1;
+    uint32_t length;
+    if (!readNumber(offset, _delay) || !readNumber(offset, length) || offset + length > _size)
+    {
+        return;
+    }
+    _type = _data[_next];
+    _payload = offset;
+    _length = length;
+}
+
+void ReplayTransport::advance()
+{
+    if (_type == 0)
+    {
+        return;
+    }
+    _next = _payload + _length;
+    _previous_at = millis();
+    parse();
+}
+
+bool ReplayTransport::due()
+{
+    return _consumed > 0 || millis() - _previous_at >= scaled(_delay);
+}
+
+uint32_t ReplayTransport::scaled(const uint32_t ms)
+{
+    return _speed > 0 ? ms / _speed : 0;
+}
+
+// the library did something else than in the recording: remember where, the rest of the
+// replay is best effort
+bool ReplayTransport::expect(const uint8_t type)
+{
+    if (_type == type)
+    {
+        return true;
+    }
+    _mismatch_at = _mismatch ? _mismatch_at : _next;
+    _mismatch = true;
+    return false;
+}
+
+bool ReplayTransport::readNumber(size_t &offset, uint32_t &number)
+{
+    number = 0;
+    for (uint8_t shift = 0; offset < _size && shift < 32; shift += 7)
+    {
+        const uint8_t byte = _data[offset++];
+        number |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
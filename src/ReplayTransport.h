@@ -0,0 +1,78 @@
+/*
+ReplayTransport.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef REPLAY_TRANSPORT_H
+#define REPLAY_TRANSPORT_H
+
+#include <Arduino.h>
+#include <RecordingTransport.h>
+
+// Plays back a transcript of RecordingTransport: the answers come with the recorded delays
+// divided by speed (0: at once), and every request of the library is compared with the
+// recorded one, so a session with a camera can be run again on a computer, without it
+class ReplayTransport : public Transport
+{
+  public:
+    ReplayTransport(const uint8_t *transcript, const size_t size, const float speed = 1);
+
+    void rewind();
+    bool valid();      // the transcript starts with a known header
+    bool finished();   // every record was played
+    bool mismatch();   // the library didn't do what was recorded
+    size_t position(); // offset of the next record, or of the first one that didn't match
+
+    bool connect(const char *host, const uint16_t port, const uint16_t timeout);
+    size_t write(const uint8_t *buffer, const size_t size);
+    int read(uint8_t *buffer, const size_t size);
+    void waitForData(const uint16_t timeout);
+    bool connected();
+    void close();
+    bool startConnect(const char *host, const uint16_t port, const uint16_t timeout);
+    int8_t finishConnect();
+    bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size);
+
+  private:
+    const uint8_t *_data;
+    size_t _size;
+    float _speed;
+    bool _valid;
+
+    size_t _next;         // offset of the next record
+    uint8_t _type;        // the next record, 0 at the end or if broken
+    uint32_t _delay;      // ms after the previous record
+    size_t _payload;      // offset of its payload
+    size_t _length;
+    size_t _consumed;     // bytes of a TRANSCRIPT_READ already given
+    uint32_t _previous_at; // millis() when the previous record was played
+
+    bool _open;
+    bool _connect_result;
+    uint32_t _connect_ready_at;
+    bool _mismatch;
+    size_t _mismatch_at;
+
+    void parse();
+    void advance();
+    bool due();
+    uint32_t scaled(const uint32_t ms);
+    bool expect(const uint8_t type);
+    bool readNumber(size_t &offset, uint32_t &number);
+};
+
+#endif //REPLAY_TRANSPORT_H
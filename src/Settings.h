@@ -19,10 +19,122 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 #define KEEP_ALIVE 1500
 #define MAX_WAIT_TIME 2000
+#define ASSOCIATION_TIMEOUT 10000
+#define RECONNECT_MIN_DELAY 1000
+#define RECONNECT_MAX_DELAY 30000
+#define MAX_FAILED_REQUESTS 3
+#define HTTP_REQUEST_SIZE 192
+#define HTTP_PATH_SIZE 128
+#define WIFI_SSID_SIZE 33     // 32 characters, the longest SSID
+#define WIFI_PASSWORD_SIZE 65 // 64 characters, the longest WPA2 key
+#define BOARD_NAME_SIZE 24    // board_name of the constructors, the name the HERO5 and newer show once paired
+#define HERO3_AUTH_SIZE 40 // "?t=" and a password up to 36 characters
+#define SCHEDULE_PREOPEN 300 // ms before a scheduled shot the connection is opened
+#define SCHEDULE_SPIN 2      // ms before a scheduled shot we stop yielding and spin on micros()
+#define CONFIRM_DEADLINE 3000 // ms shootAndConfirm() and stopAndConfirm() wait for the camera to change state
+#define CONFIRM_POLL_MIN 10    // ms between the first status reads, then it grows
+#define CONFIRM_POLL_MAX 250
+#define TRIGGER_SLOTS 4      // cameras with an armed trigger at the same time, 1 to 8
+#define TRIGGER_DEBOUNCE 50  // ms, edges closer than this to the last one are ignored
+#define TRIGGER_CHECK 200    // ms between the checks of the warm connection of an armed trigger
+#define TAG_QUEUE_SIZE 8     // tags queueTag() keeps while handleTags() sends them, a power of two
+#define TAG_REQUEST_SIZE 112 // the HTTP request of tagMoment(), built once
+#define STATUS_POLL_INTERVAL 1000 // ms between the status reads of keepAlive() when onStatusChange() was called
+#define STATUS_SUBSCRIPTIONS 4    // callbacks of onStatusChange()
+#if defined(__linux__) || defined(__APPLE__)
+#define CAMERA_GROUP_SIZE 64 // a gateway drives many cameras, each one on its own WiFi interface
+#else
+#define CAMERA_GROUP_SIZE 4 // suggested GroupSlot array of pollAllStatus() and commandAll(), more cameras are asked in groups of this size
+#endif
+#define WHEEL_TICK 20     // ms, resolution of TimerWheel
+#define WHEEL_STAGGER 500 // ms the keep alives of the cameras of a TimerWheel are spread over
+#if defined(__linux__) || defined(__APPLE__)
+#define WHEEL_CAMERAS 128 // cameras of a TimerWheel
+#else
+#define WHEEL_CAMERAS 8
+#endif
+#define CLOCK_SYNC_PORT 8484
+#define CLOCK_SYNC_TIMEOUT 100
+#define INTERVALOMETER_LOG_SIZE 8  // shots Intervalometer remembers, see getLog()
+#define INTERVALOMETER_HOLD_OFFS 4 // hold off windows of an Intervalometer
+#define ESP_AT_LINK 4         // link of AT+CIPMUX=1 used by EspAtClient, WiFiEsp uses 0 to 3
+#define ESP_AT_BUFFER_SIZE 64 // answer bytes EspAtClient keeps while the sketch reads them
+// #define DETECT_EEPROM_ADDRESS 0 // boards without Preferences cache the detected camera in the EEPROM from here, pick a free address
+#define ASYNC_BUFFER_SIZE 1024  // answer bytes AsyncTransport keeps while listenResponse() reads them
+#define BLE_SCAN_TIME 5           // seconds Esp32BleLink looks for the camera
+#define BLE_NAME_SIZE 24          // name or address of the camera an Esp32BleLink connects to
+#define ESP32_BLE_LINKS 4         // Esp32BleLink objects at once, one in every GoProControl with GOPRO_BLE
+#define BLE_CONNECT_TIMEOUT 10000 // scan, connection and pairing of enableBLE()
+#define WIFI_IDLE_TIMEOUT 60000   // with setPowerSaving() the access point is turned off after this time without requests
+#define WIFI_WAKE_TIMEOUT 20000   // time for the camera to start its access point and for us to join it
+
+// health of the link with the camera, see onStateChange()
+enum connection_state
+{
+    CAMERA_DISCONNECTED = 0, // not associated to the camera access point
+    CAMERA_ASSOCIATING,      // WiFi.begin() called, waiting for the access point
+    CAMERA_CONNECTED,        // associated and answering
+    CAMERA_DEGRADED,         // associated but the last requests failed
+    CAMERA_ASLEEP            // associated but the camera doesn't answer anymore
+};
+
+// Build only one family of cameras to save flash and RAM on small boards (for example UNO + ESP01)
+// #define GOPRO_HERO3_ONLY     // HERO3: /bacpac and /camera API
+// #define GOPRO_GPCONTROL_ONLY // HERO4 and newer: /gp/gpControl API
+
+// ESP01 with AT commands: talk HTTP directly with the module instead of through WiFiEspClient, see setEspSerial()
+// #define GOPRO_ESP_AT_CLIENT
+
+// ESP32 with the AsyncTCP library: commands complete as soon as the answer arrives, see commandAsync()
+// #define GOPRO_ASYNC_TCP
+
+// ESP32: control the camera over Bluetooth with the BLE library of the core, see enableBLE() and setBleLink()
+// #define GOPRO_BLE
+
+// Optional features, each one adds its buffers to every GoProControl: on ESP32 and in the host build
+// they are all there, on the other boards uncomment the ones you use
+// #define GOPRO_SCHEDULE      // scheduleShoot() and armTrigger(), about 230 bytes
+// #define GOPRO_TAGS          // tagMoment(), queueTag() and handleTags(), about 150 bytes
+// #define GOPRO_STATUS_EVENTS // onStatusChange()
+// #define GOPRO_RECORDER      // startRecording() and stopRecording()
+// #define GOPRO_BLE_CONTROL   // setBleLink(), enableBLE(), wifiOff(), wifiOn() and setPowerSaving()
+// #define GOPRO_CAMERA_INFO   // readCameraInfo(), getModelName() and getFirmware(), 48 bytes
+#if defined(ARDUINO_ARCH_ESP32) || !defined(ARDUINO)
+#define GOPRO_SCHEDULE
+#define GOPRO_TAGS
+#define GOPRO_STATUS_EVENTS
+#define GOPRO_RECORDER
+#define GOPRO_BLE_CONTROL
+#define GOPRO_CAMERA_INFO
+#endif
+#if defined(GOPRO_BLE) && !defined(GOPRO_BLE_CONTROL)
+#define GOPRO_BLE_CONTROL
+#endif
+
+// fields of CameraStatus, for onStatusChange(): STATUS_RECORDING | STATUS_BATTERY
+enum status_field
+{
+    STATUS_RECORDING = 0x01,
+    STATUS_MODE = 0x02,
+    STATUS_BATTERY = 0x04,
+    STATUS_VIDEO_LEFT = 0x08,
+    STATUS_ALL = 0x0F
+};
+
+// every request belongs to a class, each class has its own timeout and retry policy
+enum command_class
+{
+    CONTROL_COMMAND = 0, // power, pairing, delete: never resent once written
+    SHUTTER_COMMAND,     // shoot and stop: fail fast, never resent once written
+    SETTING_COMMAND,     // settings: safe to resend
+    STATUS_COMMAND,      // status reads: safe to resend
+    command_class_last
+};
 
 enum camera
 {
-    HERO = 1,
+    AUTO_DETECT = 0, // ask the camera in begin(), see detectCamera()
+    HERO,
     HERO2,
     HERO3,
     HERO4,
@@ -32,6 +144,21 @@ enum camera
     FUSION
 };
 
+// what a setter changes, each one has a table of options in every dialect, see Dialects.h
+enum setting_type
+{
+    SET_MODE = 0,
+    SET_ORIENTATION,
+    SET_VIDEO_RESOLUTION,
+    SET_VIDEO_FOV,
+    SET_FRAME_RATE,
+    SET_VIDEO_ENCODING,
+    SET_PHOTO_RESOLUTION,
+    SET_TIME_LAPSE_INTERVAL,
+    SET_CONTINUOUS_SHOT,
+    setting_type_last
+};
+
 //The above settings must be between a *_first and *_last member
 enum mode
 {
@@ -137,12 +264,11 @@ enum photo_resolution
     photo_resolution_last
 };
 
-#if defined(ARDUINO_ARCH_ESP32)
-const uint8_t BLE_WiFiOn[] = {17, 01, 01};
-const uint8_t BLE_WiFiOff[] = {17, 01, 00};
-const uint8_t BLE_RecordStart[] = {01, 01, 01};
-const uint8_t BLE_RecordStop[] = {01, 01, 00};
-const uint8_t BLE_ModeVideo[] = {02, 01, 00};
-const uint8_t BLE_ModePhoto[] = {02, 01, 01};
-const uint8_t BLE_ModeMultiShot[] = {02, 01, 02};
-#endif
+// BLE commands: <command id> <parameter length> <parameter>, BleControl adds the length of the whole
+const uint8_t BLE_WiFiOn[] = {0x17, 0x01, 0x01};
+const uint8_t BLE_WiFiOff[] = {0x17, 0x01, 0x00};
+const uint8_t BLE_RecordStart[] = {0x01, 0x01, 0x01};
+const uint8_t BLE_RecordStop[] = {0x01, 0x01, 0x00};
+const uint8_t BLE_ModeVideo[] = {0x02, 0x01, 0x00};
+const uint8_t BLE_ModePhoto[] = {0x02, 0x01, 0x01};
+const uint8_t BLE_ModeMultiShot[] = {0x02, 0x01, 0x02};
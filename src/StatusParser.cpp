@@ -0,0 +1,220 @@
+/*
+StatusParser.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <StatusParser.h>
+
+StatusParser::StatusParser(const StatusField fields[], const uint8_t count, char (*values)[STATUS_VALUE_SIZE])
+{
+    _fields = fields;
+    _count = min(count, (uint8_t)32);
+    _values = values;
+    reset();
+}
+
+void StatusParser::reset()
+{
+    _found = 0;
+    _depth = 0;
+    _arrays = 0;
+    _in_string = false;
+    _escape = false;
+    _reading_key = false;
+    _expect_key = false;
+    _expect_value = false;
+    _section[0] = '\0';
+    _key[0] = '\0';
+    _key_index = 0;
+    _capture = -1;
+    _value_index = 0;
+
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _values[i][0] = '\0';
+    }
+}
+
+bool StatusParser::found(const uint8_t index)
+{
+    return index < _count && (_found & ((uint32_t)1 << index));
+}
+
+bool StatusParser::completed()
+{
+    return _count > 0 && _found == (((uint32_t)1 << (_count - 1)) << 1) - 1;
+}
+
+void StatusParser::feed(const char c)
+{
+    if (_in_string)
+    {
+        if (_escape)
+        {
+            _escape = false;
+        }
+        else if (c == '\\')
+        {
+            _escape = true;
+            return;
+        }
+        else if (c == '"')
+        {
+            _in_string = false;
+            if (_reading_key)
+            {
+                _reading_key = false;
+                _key[_key_index] = '\0';
+            }
+            else if (_capture >= 0)
+            {
+                endValue();
+            }
+            return;
+        }
+
+        if (_reading_key)
+        {
+            if (_key_index < STATUS_KEY_SIZE - 1)
+            {
+                _key[_key_index++] = c;
+            }
+        }
+        else if (_capture >= 0 && _value_index < STATUS_VALUE_SIZE - 1)
+        {
+            _values[_capture][_value_index++] = c;
+        }
+        return;
+    }
+
+    switch (c)
+    {
+    case '"':
+        _in_string = true;
+        if (_expect_key)
+        {
+            _expect_key = false;
+            _reading_key = true;
+            _key_index = 0;
+        }
+        else if (_expect_value)
+        {
+            _expect_value = false;
+        }
+        return;
+
+    case ':':
+        if (_depth == 1)
+        {
+            strcpy(_section, _key);
+        }
+        matchKey();
+        _expect_value = true;
+        return;
+
+    case '{':
+    case '[':
+        _expect_value = false;
+        _capture = -1; // we copy only scalar values
+        openContainer(c == '[');
+        return;
+
+    case '}':
+    case ']':
+        if (_capture >= 0)
+        {
+            endValue();
+        }
+        closeContainer();
+        return;
+
+    case ',':
+        if (_capture >= 0)
+        {
+            endValue();
+        }
+        _expect_key = _depth > 0 && !(_arrays & (1 << (_depth - 1)));
+        return;
+
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+        return;
+
+    default: // number, true, false, null
+        _expect_value = false;
+        if (_capture >= 0 && _value_index < STATUS_VALUE_SIZE - 1)
+        {
+            _values[_capture][_value_index++] = c;
+        }
+        return;
+    }
+}
+
+void StatusParser::openContainer(const bool array)
+{
+    if (_depth < STATUS_MAX_DEPTH)
+    {
+        if (array)
+        {
+            _arrays |= (1 << _depth);
+        }
+        else
+        {
+            _arrays &= ~(1 << _depth);
+        }
+    }
+    _depth++;
+    _expect_key = !array;
+}
+
+void StatusParser::closeContainer()
+{
+    if (_depth > 0)
+    {
+        _depth--;
+    }
+    if (_depth <= 1)
+    {
+        _section[0] = '\0';
+    }
+    _expect_key = false;
+}
+
+void StatusParser::endValue()
+{
+    _values[_capture][_value_index] = '\0';
+    _found |= ((uint32_t)1 << _capture);
+    _capture = -1;
+}
+
+void StatusParser::matchKey()
+{
+    _capture = -1;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        const char *section = _fields[i].section;
+        const bool section_ok = (section == NULL) ? (_depth == 1) : (_depth == 2 && strcmp(section, _section) == 0);
+        if (section_ok && strcmp(_fields[i].key, _key) == 0)
+        {
+            _capture = i;
+            _value_index = 0;
+            return;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+StatusParser.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef STATUS_PARSER_H
+#define STATUS_PARSER_H
+
+#include <Arduino.h>
+
+#define STATUS_KEY_SIZE 24
+#define STATUS_VALUE_SIZE 24
+#define STATUS_MAX_DEPTH 8
+
+// a value we are interested in: the key inside a top level object, for example
+// {"status":{"40":"%13%01%02..."}} is {"status", "40"} and {"info":{"model_name":"HERO5 Black"}} is {"info", "model_name"}
+struct StatusField
+{
+    const char *section;
+    const char *key;
+};
+
+// Extract a few values from the JSON answers of the camera (/gp/gpControl/status, /gp/gpControl/info)
+// one byte at a time, without keeping the body in memory
+class StatusParser
+{
+  public:
+    StatusParser(const StatusField fields[], const uint8_t count, char (*values)[STATUS_VALUE_SIZE]);
+
+    void reset();
+    void feed(const char c);
+    bool found(const uint8_t index);
+    bool completed();
+
+  private:
+    const StatusField *_fields;
+    uint8_t _count;
+    char (*_values)[STATUS_VALUE_SIZE];
+    uint32_t _found;
+
+    uint8_t _depth;
+    uint8_t _arrays; // bit n set if the container at depth n+1 is an array
+    bool _in_string;
+    bool _escape;
+    bool _reading_key;
+    bool _expect_key;
+    bool _expect_value;
+
+    char _section[STATUS_KEY_SIZE];
+    char _key[STATUS_KEY_SIZE];
+    uint8_t _key_index;
+
+    int8_t _capture; // index of the field we are copying, -1 none
+    uint8_t _value_index;
+
+    void openContainer(const bool array);
+    void closeContainer();
+    void endValue();
+    void matchKey();
+};
+
+#endif //STATUS_PARSER_H
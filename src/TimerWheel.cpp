@@ -0,0 +1,175 @@
+/*
+TimerWheel.cpp
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <TimerWheel.h>
+
+TimerWheel::TimerWheel()
+{
+    for (uint8_t i = 0; i < WHEEL_CAMERAS; i++)
+    {
+        _timers[i].camera = NULL;
+        _timers[i].list = NONE;
+        _timers[i].previous = (i + 1 < WHEEL_CAMERAS) ? i + 1 : NONE;
+    }
+    for (uint8_t i = 0; i < 2 * WHEEL_SLOTS; i++)
+    {
+        _lists[i] = NONE;
+    }
+}
+
+uint8_t TimerWheel::add(GoProControl &camera)
+{
+    const uint8_t timer = _free;
+    if (timer == NONE)
+    {
+        return NONE;
+    }
+    _free = _timers[timer].previous;
+
+    if (!_started) // the clock starts here, a global wheel is built before millis() runs
+    {
+        _tick_at = millis();
+        _started = true;
+    }
+    // golden ratio steps: the phases stay spread however many cameras come
+    _timers[timer].camera = &camera;
+    _timers[timer].phase = ((uint32_t)_added * 40503 % 65536) * (WHEEL_STAGGER / WHEEL_TICK) / 65536;
+    _added++;
+    schedule(timer, camera.nextKeepAlive());
+    return timer;
+}
+
+void TimerWheel::remove(const uint8_t timer)
+{
+    if (timer >= WHEEL_CAMERAS || _timers[timer].camera == NULL)
+    {
+        return;
+    }
+    unlink(timer);
+    _timers[timer].camera = NULL;
+    _timers[timer].previous = _free; // next is left alone, handle() may be walking through it
+    _free = timer;
+}
+
+uint16_t TimerWheel::handle()
+{
+    uint16_t due = 0;
+    if (!_started)
+    {
+        return due;
+    }
+    while (millis() - _tick_at >= WHEEL_TICK)
+    {
+        _tick++;
+        _tick_at += WHEEL_TICK;
+        const uint8_t slot = _tick % WHEEL_SLOTS;
+
+        if (slot == 0) // a new round of level 0: the next level 1 list comes down
+        {
+            uint8_t timer = _lists[WHEEL_SLOTS + (_tick / WHEEL_SLOTS) % WHEEL_SLOTS];
+            _lists[WHEEL_SLOTS + (_tick / WHEEL_SLOTS) % WHEEL_SLOTS] = NONE;
+            while (timer != NONE)
+            {
+                const uint8_t next = _timers[timer].next;
+                link(timer, _timers[timer].expires % WHEEL_SLOTS);
+                timer = next;
+            }
+        }
+
+        // take the whole list first: a camera done now goes back in a later one
+        uint8_t timer = _lists[slot];
+        _lists[slot] = NONE;
+        for (uint8_t t = timer; t != NONE; t = _timers[t].next)
+        {
+            _timers[t].list = NONE;
+        }
+        while (timer != NONE)
+        {
+            const uint8_t next = _timers[timer].next;
+            GoProControl *camera = _timers[timer].camera;
+            if (camera != NULL) // not removed by the keepAlive() of another one
+            {
+                camera->keepAlive();
+                if (_timers[timer].camera == camera && _timers[timer].list == NONE)
+                {
+                    schedule(timer, camera->nextKeepAlive());
+                }
+                due++;
+            }
+            timer = next;
+        }
+    }
+    return due;
+}
+
+void TimerWheel::schedule(const uint8_t timer, const uint32_t delay)
+{
+    unlink(timer);
+
+    // from the start of the current tick, at least the next one and at most the span of
+    // level 1 (the camera is asked again then)
+    uint32_t ticks = (delay + (millis() - _tick_at) + WHEEL_TICK - 1) / WHEEL_TICK + _timers[timer].phase;
+    ticks = constrain(ticks, (uint32_t)1, (uint32_t)(WHEEL_SLOTS - 1) * WHEEL_SLOTS);
+    _timers[timer].expires = _tick + ticks;
+
+    if (ticks < WHEEL_SLOTS)
+    {
+        link(timer, _timers[timer].expires % WHEEL_SLOTS);
+    }
+    else
+    {
+        link(timer, WHEEL_SLOTS + (_timers[timer].expires / WHEEL_SLOTS) % WHEEL_SLOTS);
+    }
+}
+
+void TimerWheel::link(const uint8_t timer, const uint8_t list)
+{
+    _timers[timer].list = list;
+    _timers[timer].previous = NONE;
+    _timers[timer].next = _lists[list];
+    if (_lists[list] != NONE)
+    {
+        _timers[_lists[list]].previous = timer;
+    }
+    _lists[list] = timer;
+}
+
+void TimerWheel::unlink(const uint8_t timer)
+{
+    Timer &t = _timers[timer];
+    if (t.camera == NULL || t.list == NONE)
+    {
+        return;
+    }
+
+    if (t.previous != NONE)
+    {
+        _timers[t.previous].next = t.next;
+    }
+    else
+    {
+        _lists[t.list] = t.next;
+    }
+    if (t.next != NONE)
+    {
+        _timers[t.next].previous = t.previous;
+    }
+    t.list = NONE;
+}
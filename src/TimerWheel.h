@@ -0,0 +1,70 @@
+/*
+TimerWheel.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <GoProControl.h>
+
+// Calls keepAlive() of many cameras when each one needs it, instead of every camera at every
+// loop(): a camera sleeps in the wheel until nextKeepAlive() and handle() only looks at the
+// cameras due in the current tick. Two levels of WHEEL_SLOTS lists, WHEEL_TICK ms each, then
+// WHEEL_SLOTS ticks each: add, move and remove are O(1) whatever the number of cameras.
+// Every camera is late by its own share of WHEEL_STAGGER, so the keep alives of cameras that
+// were all used together don't go on air together
+static_assert(WHEEL_CAMERAS < 255, "WHEEL_CAMERAS must be lower than 255, the timers are uint8_t and 0xFF is none");
+
+class TimerWheel
+{
+  public:
+    static const uint8_t NONE = 0xFF; // no timer, what add() returns when the wheel is full
+
+    TimerWheel();
+
+    uint8_t add(GoProControl &camera); // the timer of the camera, keep it for remove()
+    void remove(const uint8_t timer);
+    uint16_t handle(); // how many cameras were due
+
+  private:
+    static const uint8_t WHEEL_SLOTS = 64;
+
+    struct Timer
+    {
+        GoProControl *camera; // NULL if free
+        uint32_t expires;     // tick
+        uint16_t phase;       // ticks added to every deadline
+        uint8_t list;         // the level 0 slots, then the level 1 ones
+        uint8_t previous;     // also the next free timer
+        uint8_t next;
+    };
+
+    Timer _timers[WHEEL_CAMERAS];
+    uint8_t _lists[2 * WHEEL_SLOTS];
+    uint8_t _free = 0;     // first free timer
+    uint32_t _tick = 0;    // ticks since the construction
+    uint32_t _tick_at;     // millis() of _tick, from the first add()
+    bool _started = false; // the clock runs, _tick_at is set
+    uint8_t _added = 0;    // cameras ever added, for the phase of the next one (it wraps)
+
+    void schedule(const uint8_t timer, const uint32_t delay);
+    void link(const uint8_t timer, const uint8_t list);
+    void unlink(const uint8_t timer);
+};
+
+#endif //TIMER_WHEEL_H
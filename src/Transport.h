@@ -0,0 +1,65 @@
+/*
+Transport.h
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// What GoProControl needs from the network: one TCP connection at a time and a datagram for the
+// wake on lan. The commands only talk to this interface, so the stack under it can change:
+// ClientTransport for the Arduino WiFi libraries, PosixTransport for sockets on a computer
+class Transport
+{
+  public:
+    virtual ~Transport() {}
+
+    // open a TCP connection, true if connected within timeout milliseconds
+    virtual bool connect(const char *host, const uint16_t port, const uint16_t timeout) = 0;
+    // write all the bytes, return how many were written
+    virtual size_t write(const uint8_t *buffer, const size_t size) = 0;
+    // never blocks: the number of bytes read, 0 if nothing arrived yet, -1 if closed and nothing left
+    virtual int read(uint8_t *buffer, const size_t size) = 0;
+    // return when there is something to read, the connection closed or timeout milliseconds passed
+    virtual void waitForData(const uint16_t timeout) = 0;
+    virtual bool connected() = 0;
+    virtual void close() = 0;
+
+    // open a TCP connection without waiting for it, then call finishConnect() until it isn't 0:
+    // 1 open, -1 failed. Used to talk to several cameras at once, by default it is connect()
+    virtual bool startConnect(const char *host, const uint16_t port, const uint16_t timeout)
+    {
+        return connect(host, port, timeout);
+    }
+    virtual int8_t finishConnect()
+    {
+        return connected() ? 1 : -1;
+    }
+    // the socket under the transport for an event loop (epoll), -1 if there isn't one
+    virtual int descriptor()
+    {
+        return -1;
+    }
+
+    // a single UDP packet, host can be a broadcast address
+    virtual bool sendDatagram(const char *host, const uint16_t port, const uint8_t *buffer, const size_t size) = 0;
+};
+
+#endif //TRANSPORT_H